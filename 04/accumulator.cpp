@@ -0,0 +1,74 @@
+#include "accumulator.h"
+#include "kernels.h"
+
+TBigIntAccumulator::TBigIntAccumulator() : positive(), negative(), terms(0) {}
+
+void TBigIntAccumulator::accumulate(const TBigInt &obj, bool subtract) {
+    if (terms == maxTerms) {
+        normalize(positive);
+        normalize(negative);
+        terms = 0;
+    }
+    ++terms;
+    std::vector<uint64_t> &slots = obj.neg != subtract ? negative : positive;
+    if (slots.size() < obj.data.size()) {
+        slots.resize(obj.data.size());
+    }
+    addWideN(slots.data(), obj.data.begin(), obj.data.size());
+}
+
+void TBigIntAccumulator::normalize(std::vector<uint64_t> &slots) {
+    uint64_t carry = 0;
+    for (uint64_t &slot : slots) {
+        uint64_t low = (slot & UINT32_MAX) + carry;
+        carry = (slot >> TBigInt::limbBits) + (low >> TBigInt::limbBits);
+        slot = low & UINT32_MAX;
+    }
+    for (; carry; carry >>= TBigInt::limbBits) {
+        slots.push_back(carry & UINT32_MAX);
+    }
+}
+
+TVector TBigIntAccumulator::limbs(std::vector<uint64_t> slots) {
+    normalize(slots);
+    TVector res;
+    res.resize(slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        res[i] = static_cast<uint32_t>(slots[i]);
+    }
+    return res;
+}
+
+TBigIntAccumulator& TBigIntAccumulator::operator+=(const TBigInt &obj) {
+    accumulate(obj, false);
+    return *this;
+}
+
+TBigIntAccumulator& TBigIntAccumulator::operator-=(const TBigInt &obj) {
+    accumulate(obj, true);
+    return *this;
+}
+
+void TBigIntAccumulator::add(const TBigInt *first, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        accumulate(first[i], false);
+    }
+}
+
+void TBigIntAccumulator::sub(const TBigInt *first, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        accumulate(first[i], true);
+    }
+}
+
+void TBigIntAccumulator::clear() {
+    positive.clear();
+    negative.clear();
+    terms = 0;
+}
+
+TBigInt TBigIntAccumulator::result() const {
+    TBigInt res(limbs(positive));
+    res -= TBigInt(limbs(negative));
+    return res;
+}
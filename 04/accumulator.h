@@ -0,0 +1,31 @@
+#pragma once
+
+#include "bigint.h"
+
+#include <vector>
+
+// Running sum of many numbers. Limbs are added into 64-bit slots without carrying,
+// positive and negative terms into separate slot arrays, and carries are only
+// propagated when a slot could overflow or the sum is asked for.
+class TBigIntAccumulator {
+private:
+    constexpr static uint64_t maxTerms = UINT32_MAX;    // 32-bit limbs a normalized slot can absorb
+
+    std::vector<uint64_t> positive;
+    std::vector<uint64_t> negative;
+    uint64_t terms;                                     // added since the last normalization
+
+    void accumulate(const TBigInt&, bool);
+    static void normalize(std::vector<uint64_t>&);
+    static TVector limbs(std::vector<uint64_t>);
+public:
+    TBigIntAccumulator();
+
+    TBigIntAccumulator& operator+=(const TBigInt&);
+    TBigIntAccumulator& operator-=(const TBigInt&);
+    void add(const TBigInt*, size_t);
+    void sub(const TBigInt*, size_t);
+    void clear();
+
+    TBigInt result() const;
+};
@@ -0,0 +1,147 @@
+#include "bigint.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Timings of the basic operations over operand sizes in limbs, written as JSON with one
+// result per line. With --compare the run is checked against such a file and the exit
+// status is 1 if anything got slower than the tolerance allows.
+struct TResult {
+    std::string name;
+    size_t lhs;
+    size_t rhs;
+    double ns;                                          // per operation, best of the batches
+};
+
+struct TOptions {
+    std::string output = "bench.json";
+    std::string baseline = "";                          // no comparison when empty
+    double tolerance = 0.1;
+    double minTime = 0.3;                               // seconds per case, split over the batches
+    size_t maxLimbs = 1'000'000;
+};
+
+static std::vector<TResult> run(const TOptions &options) {
+    std::mt19937 gen(20240601);
+    std::vector<TResult> results;
+    auto add = [&](const std::string &name, size_t lhs, size_t rhs, const std::function<void()> &op) {
+        results.push_back({ name, lhs, rhs, measure(op, options.minTime) });
+        const TResult &last = results.back();
+        std::fprintf(stderr, "%-8s %8zu x %-8zu %14.1f ns\n", last.name.c_str(), last.lhs, last.rhs, last.ns);
+    };
+    for (size_t size = 1; size <= options.maxLimbs; size *= 10) {
+        TBigInt lhs = randomNumber(size, gen), rhs = randomNumber(size, gen), next = lhs + 1, res;
+        TBigInt narrow = randomNumber(std::max<size_t>(size / 10, 1), gen);   // the unbalanced shapes
+        std::string text(size * 10 + 2, '\0');
+        text.resize(to_chars(text.data(), text.data() + text.size(), lhs).ptr - text.data());
+        add("parse", size, 0, [&] { from_chars(text.data(), text.data() + text.size(), res); });
+        add("print", size, 0, [&] { to_chars(text.data(), text.data() + text.size(), lhs); });
+        volatile bool less = false;
+        add("compare", size, size, [&] { less = lhs < next; }); // the lowest limbs decide
+        add("add", size, size, [&] { res = lhs + rhs; });
+        add("sub", size, size, [&] { res = lhs - rhs; });
+        add("mul", size, size, [&] { res = lhs * rhs; });
+        if (size >= 10) {
+            add("add", size, size / 10, [&] { res = lhs + narrow; });
+            add("sub", size, size / 10, [&] { res = lhs - narrow; });
+            add("mul", size, size / 10, [&] { res = lhs * narrow; });
+        }
+    }
+    return results;
+}
+
+static void write(const std::string &path, const std::vector<TResult> &results) {
+    std::ofstream out(path);
+    out << "{\n  \"version\": 1,\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "    { \"name\": \"%s\", \"lhs\": %zu, \"rhs\": %zu, \"ns\": %.1f }%s\n",
+            results[i].name.c_str(), results[i].lhs, results[i].rhs, results[i].ns, i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    if (!out) {
+        throw std::runtime_error("benchmark: cannot write " + path);
+    }
+}
+
+// Reads back what write() produced, one result per line.
+static std::vector<TResult> read(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("benchmark: cannot read " + path);
+    }
+    std::vector<TResult> results;
+    for (std::string line; std::getline(in, line); ) {
+        char name[64];
+        TResult result{ "", 0, 0, 0 };
+        if (std::sscanf(line.c_str(), " { \"name\": \"%63[^\"]\", \"lhs\": %zu, \"rhs\": %zu, \"ns\": %lf", name, &result.lhs, &result.rhs, &result.ns) == 4) {
+            result.name = name;
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+static bool compare(const std::vector<TResult> &baseline, const std::vector<TResult> &results, double tolerance) {
+    std::map<std::tuple<std::string, size_t, size_t>, double> previous;
+    for (const TResult &result : baseline) {
+        previous[{ result.name, result.lhs, result.rhs }] = result.ns;
+    }
+    size_t regressions = 0;
+    for (const TResult &result : results) {
+        auto it = previous.find({ result.name, result.lhs, result.rhs });
+        if (it == previous.end()) {
+            continue;
+        }
+        double ratio = result.ns / it->second;
+        const char *verdict = ratio > 1 + tolerance ? "SLOWER" : ratio < 1 - tolerance ? "faster" : "";
+        regressions += ratio > 1 + tolerance;
+        std::printf("%-8s %8zu x %-8zu %14.1f -> %14.1f ns  %6.2fx  %s\n",
+            result.name.c_str(), result.lhs, result.rhs, it->second, result.ns, ratio, verdict);
+    }
+    std::printf("%zu regression(s) beyond %.0f%%\n", regressions, tolerance * 100);
+    return !regressions;
+}
+
+int main(int argc, char **argv) {
+    TOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--output" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--compare" && hasValue) {
+            options.baseline = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            options.tolerance = std::stod(argv[++i]);
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTime = std::stod(argv[++i]);
+        } else if (arg == "--max-limbs" && hasValue) {
+            options.maxLimbs = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--output FILE] [--compare BASELINE] [--tolerance 0.1]"
+                      << " [--min-time SECONDS] [--max-limbs N]" << std::endl;
+            return 2;
+        }
+    }
+    try {
+        std::vector<TResult> results = run(options);
+        write(options.output, results);
+        if (!options.baseline.empty()) {
+            return compare(read(options.baseline), results, options.tolerance) ? 0 : 1;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
@@ -1,7 +1,14 @@
 #include "bigint.h"
+#include "kernels.h"
+#include "ntt.h"
+#include "threadpool.h"
 
+#include <algorithm>
 #include <charconv>
-#include <iomanip>
+#include <cstdlib>
+#include <deque>
+#include <stdexcept>
+#include <tuple>
 
 std::string_view strip(std::string_view src) {
     while (!src.empty() && isspace(src.front())) {
@@ -20,35 +27,133 @@ bool TBigInt::removeLeadingZeros(TVector &data) {
     return data.empty();
 }
 
-void TBigInt::readBigInt(std::string_view src) {
-    neg = src.front() == '-';
-    src.remove_prefix(src.front() == '-' || src.front() == '+');
-    for (int32_t i = src.size(); i > 0; i -= digitShift) {
-        const char *ptr = i < digitShift ? src.data() : &src[i - digitShift];
-        uint32_t digit = 0;
-        std::from_chars(ptr, ptr + std::min(i, digitShift), digit);
-        data.push_back(digit);
+static void mulAddWord(TVector &data, uint32_t mul, uint32_t add) {
+    uint32_t carry = mul1(data.begin(), data.begin(), data.size(), mul);
+    carry += add1(data.begin(), data.begin(), data.size(), add);    // the sum still fits one more limb
+    if (carry) {
+        data.push_back(carry);
     }
-    neg = removeLeadingZeros(data) ? false : neg;
 }
 
-TBigInt::TBigInt() : neg(), data() {}
+static uint32_t divModWord(TVector &data, uint32_t div) {
+    uint64_t rem = 0;
+    for (auto it = data.rbegin(); it != data.rend(); ++it) {
+        uint64_t curr = rem << TBigInt::limbBits | *it;
+        *it = curr / div;
+        rem = curr % div;
+    }
+    TBigInt::removeLeadingZeros(data);
+    return rem;
+}
+
+static uint32_t addLimbs(uint32_t *res, TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    uint32_t carry = addN(res, lhs.begin(), rhs.begin(), rhs.size());   // lhs.size() >= rhs.size()
+    return add1(res + rhs.size(), lhs.begin() + rhs.size(), lhs.size() - rhs.size(), carry);
+}
+
+static void addInPlace(uint32_t *res, size_t size, TVector::TVectorView src) {
+    uint32_t carry = addN(res, res, src.begin(), src.size());   // the sum must fit into size limbs
+    add1(res + src.size(), res + src.size(), size - src.size(), carry);
+}
+
+static void subInPlace(uint32_t *res, size_t size, TVector::TVectorView src) {
+    uint32_t borrow = subN(res, res, src.begin(), src.size());  // the difference must be non-negative
+    sub1(res + src.size(), res + src.size(), size - src.size(), borrow);
+}
+
+static void addShifted(TVector &res, TVector::TVectorView src, size_t offset) {
+    addInPlace(res.begin() + offset, res.size() - offset, src);
+}
 
-TBigInt::TBigInt(uint32_t val) : neg(val & signBit), data() {
-    val = neg ? ~val + 1 : val;
-    while (val) {
-        data.push_back(val % base);
-        val /= base;
+static int compareMagnitude(TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size() ? -1 : 1;
     }
+    return compareN(lhs.begin(), rhs.begin(), lhs.size());
+}
+
+static void schoolbook(uint32_t *res, TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    if (rhs.empty()) {
+        std::fill(res, res + lhs.size(), 0);
+        return;
+    }
+    res[lhs.size()] = mul1(res, lhs.begin(), lhs.size(), rhs.begin()[0]);     // rows along the longer lhs
+    for (size_t i = 1; i < rhs.size(); ++i) {
+        res[i + lhs.size()] = addMul1(res + i, lhs.begin(), lhs.size(), rhs.begin()[i]);
+    }
+}
+
+static size_t bitLength(TVector::TVectorView src) {
+    size_t size = src.size();
+    while (size && !src.begin()[size - 1]) {
+        --size;
+    }
+    return size ? TBigInt::limbBits * size - __builtin_clz(src.begin()[size - 1]) : 0;
+}
+
+static TVector shiftLeftBits(TVector::TVectorView src, size_t bits) {
+    TVector res;                                        // src.size() + bits / 32 + 1 limbs
+    size_t limbs = bits / TBigInt::limbBits;
+    res.resize_uninitialized(src.size() + limbs + 1);
+    std::fill(res.begin(), res.begin() + limbs, 0);
+    res.back() = shiftLeftN(res.begin() + limbs, src.begin(), src.size(), bits % TBigInt::limbBits);
+    return res;
+}
+
+static TVector shiftRightBits(TVector::TVectorView src, size_t bits) {
+    TVector res;
+    size_t limbs = bits / TBigInt::limbBits;
+    if (src.size() <= limbs) {
+        return res;
+    }
+    res.resize_uninitialized(src.size() - limbs);
+    shiftRightN(res.begin(), src.begin() + limbs, res.size(), bits % TBigInt::limbBits);
+    TBigInt::removeLeadingZeros(res);
+    return res;
+}
+
+static void schoolbookSquare(uint32_t *res, TVector::TVectorView src) {
+    size_t size = src.size();
+    std::fill(res, res + 2 * size, 0);
+    for (size_t i = 0; i < size; ++i) {                 // cross products below the diagonal once
+        res[i + size] = addMul1(res + 2 * i + 1, src.begin() + i + 1, size - i - 1, src.begin()[i]);
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < 2 * size; ++i) {             // double them and add the squares
+        uint64_t diagonal = static_cast<uint64_t>(src.begin()[i / 2]) * src.begin()[i / 2];
+        carry += (static_cast<uint64_t>(res[i]) << 1) + static_cast<uint32_t>(i & 1 ? diagonal >> TBigInt::limbBits : diagonal);
+        res[i] = static_cast<uint32_t>(carry);
+        carry >>= TBigInt::limbBits;
+    }
+}
+
+static std::unique_ptr<TThreadPool> pool;
+static size_t parallelLimbs = 0;
+
+static_assert(tunedKaratsubaThreshold >= 4 && tunedKaratsubaThreshold <= tunedToom3Threshold
+    && tunedToom3Threshold <= tunedToom4Threshold && tunedToom4Threshold <= tunedNttThreshold,
+    "thresholds.h: the tiers are tried from the top, each threshold has to be at least the one below");
+TBigInt::TThresholds TBigInt::thresholds;               // constant initialized, usable from other static initializers
+
+TBigInt::TBigInt() : neg(), data() {}
+
+TBigInt::TBigInt(TVector::TVectorView view, bool negative) : neg(negative), data(view) {
+    neg = removeLeadingZeros(data) ? false : neg;
 }
 
 TBigInt::TBigInt(std::string_view str) : neg(), data() {
     std::string_view stripped_str = strip(str);
-    readBigInt(stripped_str);
+    const char *last = stripped_str.data() + stripped_str.size();
+    auto [ptr, ec] = from_chars(stripped_str.data(), last, *this);
+    if (ec != std::errc() || ptr != last) {
+        throw std::invalid_argument("TBigInt: not a decimal number");
+    }
 }
 
 TBigInt::TBigInt(const TBigInt &obj) : neg(obj.neg), data(obj.data) {}
 
+TBigInt::TBigInt(const TBigIntView &obj) : TBigInt(obj.limbs(), obj.negative()) {}
+
 TBigInt::TBigInt(TBigInt &&obj) : neg(obj.neg), data(std::move(obj.data)) {
     obj.neg = false;
 }
@@ -58,17 +163,110 @@ void TBigInt::clear() {
     data.clear();
 }
 
-TBigInt& TBigInt::operator=(uint32_t val) {
-    neg = val & signBit;
+void TBigInt::assignWord(uint64_t val, bool negative) {
+    neg = negative && val;
     data.clear();
-    val = neg ? ~val + 1 : val;
-    while (val) {
-        data.push_back(val % base);
-        val /= base;
+    for (; val; val >>= limbBits) {
+        data.push_back(static_cast<uint32_t>(val));
     }
+}
+
+uint64_t TBigInt::lowWord() const {
+    uint64_t res = 0;
+    for (size_t i = std::min<size_t>(data.size(), 2); i--; ) {
+        res = res << limbBits | data[i];
+    }
+    return res;
+}
+
+TBigInt& TBigInt::addWord(uint64_t val, bool negative) {
+    const uint32_t limbs[2] = { static_cast<uint32_t>(val), static_cast<uint32_t>(val >> limbBits) };
+    TVector::TVectorView src(limbs[1] ? 2 : limbs[0] ? 1 : 0, limbs);
+    if (neg == negative) {
+        addMagnitude(src);
+    } else {
+        subMagnitude(src);
+    }
+    return *this;
+}
+
+TBigInt& TBigInt::mulWord(uint64_t val, bool negative) {
+    if (val >> limbBits) {
+        unsigned __int128 carry = 0;
+        for (uint32_t &limb : data) {
+            carry += static_cast<unsigned __int128>(limb) * val;
+            limb = static_cast<uint32_t>(carry);
+            carry >>= limbBits;
+        }
+        for (; carry; carry >>= limbBits) {
+            data.push_back(static_cast<uint32_t>(carry));
+        }
+    } else {
+        mulAddWord(data, static_cast<uint32_t>(val), 0);
+    }
+    neg = removeLeadingZeros(data) ? false : neg != negative;
+    return *this;
+}
+
+uint64_t TBigInt::divWord(uint64_t val, bool negative) {
+    if (!val) {
+        throw std::domain_error("TBigInt: division by zero");
+    }
+    uint64_t rem = 0;
+    if (val >> limbBits) {                              // the running remainder stays below 2^96
+        for (auto it = data.rbegin(); it != data.rend(); ++it) {
+            unsigned __int128 curr = static_cast<unsigned __int128>(rem) << limbBits | *it;
+            *it = static_cast<uint32_t>(curr / val);
+            rem = static_cast<uint64_t>(curr % val);
+        }
+        removeLeadingZeros(data);
+    } else {
+        rem = divModWord(data, static_cast<uint32_t>(val));
+    }
+    neg = data.empty() ? false : neg != negative;
+    return rem;
+}
+
+TBigInt& TBigInt::divExactWord(uint32_t val) {
+    divModWord(data, val);
+    neg = data.empty() ? false : neg;
     return *this;
 }
 
+void TBigInt::addMagnitude(TVector::TVectorView src) {
+    if (data.size() < src.size()) {
+        data.resize(src.size());
+    }
+    uint32_t carry = addN(data.begin(), data.begin(), src.begin(), src.size());
+    for (size_t i = src.size(); carry && i < data.size(); ++i) {
+        carry = !++data[i];
+    }
+    if (carry) {
+        data.push_back(carry);
+    }
+}
+
+void TBigInt::subMagnitude(TVector::TVectorView src) {
+    bool flip = compareMagnitude(data, src) < 0;
+    if (flip) {                                         // |data| < |src|: store src - data
+        data.resize(src.size());
+        subN(data.begin(), src.begin(), data.begin(), src.size());
+    } else {
+        subInPlace(data.begin(), data.size(), src);
+    }
+    neg = removeLeadingZeros(data) ? false : neg != flip;
+}
+
+TBigInt TBigInt::shiftLimbs(size_t limbs) const {
+    TBigInt res;
+    if (!data.empty()) {
+        res.neg = neg;
+        res.data.resize(data.size() + limbs);
+        std::copy(data.begin(), data.end(), res.data.begin() + limbs);
+    }
+    return res;
+}
+
 TBigInt& TBigInt::operator=(const TBigInt &obj) {
     neg = obj.neg;
     data = obj.data;
@@ -88,10 +286,10 @@ bool TBigInt::operator<(const TBigInt &obj) const {
     }
     if (data.size() != obj.data.size()) {
         return data.size() < obj.data.size() ? !neg : neg;
-    } else if (std::lexicographical_compare(data.rbegin(), data.rend(), obj.data.rbegin(), obj.data.rend())) {
-        return !neg;
+    } else if (neg) {
+        return compareN(obj.data.begin(), data.begin(), data.size()) < 0;
     }
-    return neg;
+    return compareN(data.begin(), obj.data.begin(), data.size()) < 0;
 }
 
 bool TBigInt::operator>(const TBigInt &obj) const {
@@ -119,88 +317,391 @@ bool TBigInt::operator>=(const TBigInt &obj) const {
 
 TBigInt TBigInt::operator-() const {
     TBigInt res = *this;
-    if (res != 0) {
-        res.neg = !neg;
-    }
+    res.neg = !data.empty() && !neg;
     return res;
 }
 
 TVector operator-(TVector::TVectorView lhs, TVector::TVectorView rhs) {
-    TVector res = lhs;
-    res.resize(lhs.size() + 1);
-    for (size_t i = 0, carry = 0; i < rhs.size() || carry; ++i) {
-        res[i] -= rhs[i] + carry;
-        if ((carry = !!(res[i] & TBigInt::signBit))) {  // -Werror=parentheses
-            res[i] += TBigInt::base;
-        }
-    }
+    TVector res;                                        // lhs >= rhs
+    res.resize_uninitialized(lhs.size());
+    uint32_t borrow = subN(res.begin(), lhs.begin(), rhs.begin(), rhs.size());
+    sub1(res.begin() + rhs.size(), lhs.begin() + rhs.size(), lhs.size() - rhs.size(), borrow);
     return res;
 }
 
 TBigInt TBigInt::operator-(const TBigInt &obj) const {
-    if (neg != obj.neg) {
-        return *this + (-obj);
-    } else if (neg != (*this < obj)) {
-        return -(obj - *this);
+    return addSigned(*this, -TBigIntView(obj));
+}
+
+TVector operator+(TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    if (lhs.size() < rhs.size()) {
+        std::swap(lhs, rhs);
     }
+    TVector res;
+    res.resize_uninitialized(lhs.size() + 1);
+    res.back() = addLimbs(res.begin(), lhs, rhs);
+    if (!res.back()) {
+        res.pop_back();
+    }
+    return res;
+}
+
+// Signs and magnitudes are taken from the views as they are, so the only pass over the
+// limbs is the one writing the result.
+TBigInt TBigInt::addSigned(const TBigIntView &lhs, const TBigIntView &rhs) {
     TBigInt res;
-    res.data = this->data - obj.data;
-    res.neg = removeLeadingZeros(res.data) ? false : neg;
+    if (lhs.negative() == rhs.negative()) {
+        res.data = lhs.limbs() + rhs.limbs();
+        res.neg = lhs.negative() && !res.data.empty();
+        return res;
+    }
+    bool flip = compareMagnitude(lhs.limbs(), rhs.limbs()) < 0;
+    res.data = flip ? rhs.limbs() - lhs.limbs() : lhs.limbs() - rhs.limbs();
+    res.neg = removeLeadingZeros(res.data) ? false : lhs.negative() != flip;
     return res;
 }
 
-TVector operator+(TVector::TVectorView lhs, TVector::TVectorView rhs) {
+TBigInt TBigInt::operator+(const TBigInt &obj) const {
+    return addSigned(*this, obj);
+}
+
+std::pair<TBigInt, TBigInt> TBigInt::evaluate(std::initializer_list<TVector::TVectorView> parts, uint32_t point) {
+    TVector even, odd;                                  // horner in point^2 over each half
+    for (size_t i = parts.size(); i--; ) {
+        TVector &acc = i & 1 ? odd : even;
+        if (point != 1) {
+            mulAddWord(acc, point * point, 0);
+        }
+        acc = acc + parts.begin()[i];
+    }
+    if (point != 1) {
+        mulAddWord(odd, point, 0);
+    }
+    TBigInt evenPart(even), oddPart(odd);
+    return { evenPart + oddPart, evenPart - oddPart };
+}
+
+TVector TBigInt::toomCook3(TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    size_t len = (lhs.size() + 2) / 3;
+    auto [a0, a12] = lhs.split(len);
+    auto [a1, a2] = a12.split(len);
+    auto [b0, b12] = rhs.split(len);
+    auto [b1, b2] = b12.split(len);
+
+    bool square = lhs.begin() == rhs.begin() && lhs.size() == rhs.size();
+    auto [p1, pm1] = evaluate({ a0, a1, a2 }, 1);       // points 0, 1, -1, 2, inf
+    auto [q1, qm1] = square ? std::pair<TBigInt, TBigInt>() : evaluate({ b0, b1, b2 }, 1);
+    TBigInt p2 = evaluate({ a0, a1, a2 }, 2).first;
+    TBigInt q2 = square ? TBigInt() : evaluate({ b0, b1, b2 }, 2).first;
+    TBigInt r0(a0 * b0), rInf(a2 * b2);                 // the same object on both sides squares
+    TBigInt r1 = p1 * (square ? p1 : q1), rm1 = pm1 * (square ? pm1 : qm1);
+    TBigInt r2 = p2 * (square ? p2 : q2);
+
+    TBigInt odd = (r1 - rm1).divExactWord(2);           // c1 + c3
+    TBigInt c2 = (r1 + rm1).divExactWord(2) - r0 - rInf;
+    TBigInt c3 = ((r2 - r0 - TBigInt(c2).mulWord(4) - TBigInt(rInf).mulWord(16)).divExactWord(2) - odd).divExactWord(3);
+    TBigInt c1 = odd - c3;
+
     TVector res;
-    res.reserve(std::max(lhs.size(), rhs.size()) + 1);
-    res = lhs;
-    for (size_t i = 0, carry = 0; i < std::max(res.size(), rhs.size()) || carry; ++i) {
-        if (i == res.size()) {
-            res.push_back(0);
+    res.resize(lhs.size() + rhs.size() + 1);
+    addShifted(res, r0.data, 0);
+    addShifted(res, c1.data, len);
+    addShifted(res, c2.data, 2 * len);
+    addShifted(res, c3.data, 3 * len);
+    addShifted(res, rInf.data, 4 * len);
+    return res;
+}
+
+TVector TBigInt::toomCook4(TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    size_t len = (lhs.size() + 3) / 4;
+    auto [a01, a23] = lhs.split(2 * len);
+    auto [a0, a1] = a01.split(len);
+    auto [a2, a3] = a23.split(len);
+    auto [b01, b23] = rhs.split(2 * len);
+    auto [b0, b1] = b01.split(len);
+    auto [b2, b3] = b23.split(len);
+
+    bool square = lhs.begin() == rhs.begin() && lhs.size() == rhs.size();
+    auto [p1, pm1] = evaluate({ a0, a1, a2, a3 }, 1);   // points 0, 1, -1, 2, -2, 3, inf
+    auto [q1, qm1] = square ? std::pair<TBigInt, TBigInt>() : evaluate({ b0, b1, b2, b3 }, 1);
+    auto [p2, pm2] = evaluate({ a0, a1, a2, a3 }, 2);
+    auto [q2, qm2] = square ? std::pair<TBigInt, TBigInt>() : evaluate({ b0, b1, b2, b3 }, 2);
+    TBigInt p3 = evaluate({ a0, a1, a2, a3 }, 3).first;
+    TBigInt q3 = square ? TBigInt() : evaluate({ b0, b1, b2, b3 }, 3).first;
+    TBigInt r0(a0 * b0), rInf(a3 * b3);                 // the same object on both sides squares
+    TBigInt r1 = p1 * (square ? p1 : q1), rm1 = pm1 * (square ? pm1 : qm1);
+    TBigInt r2 = p2 * (square ? p2 : q2), rm2 = pm2 * (square ? pm2 : qm2);
+    TBigInt r3 = p3 * (square ? p3 : q3);
+
+    TBigInt even1 = (r1 + rm1).divExactWord(2) - r0 - rInf;                                 // c2 + c4
+    TBigInt odd1 = (r1 - rm1).divExactWord(2);                                              // c1 + c3 + c5
+    TBigInt even2 = ((r2 + rm2).divExactWord(2) - r0 - TBigInt(rInf).mulWord(64)).divExactWord(4);
+    TBigInt odd2 = (r2 - rm2).divExactWord(4);                                              // c1 + 4c3 + 16c5
+    TBigInt c4 = (even2 - even1).divExactWord(3);
+    TBigInt c2 = even1 - c4;
+    TBigInt odd3 = (r3 - r0 - TBigInt(c2).mulWord(9) - TBigInt(c4).mulWord(81) - TBigInt(rInf).mulWord(729)).divExactWord(3);
+    TBigInt lo = (odd2 - odd1).divExactWord(3);         // c3 + 5c5
+    TBigInt hi = (odd3 - odd1).divExactWord(8);         // c3 + 10c5
+    TBigInt c5 = (hi - lo).divExactWord(5);
+    TBigInt c3 = lo - TBigInt(c5).mulWord(5);
+    TBigInt c1 = odd1 - c3 - c5;
+
+    TVector res;
+    res.resize(lhs.size() + rhs.size() + 1);
+    addShifted(res, r0.data, 0);
+    addShifted(res, c1.data, len);
+    addShifted(res, c2.data, 2 * len);
+    addShifted(res, c3.data, 3 * len);
+    addShifted(res, c4.data, 4 * len);
+    addShifted(res, c5.data, 5 * len);
+    addShifted(res, rInf.data, 6 * len);
+    return res;
+}
+
+size_t TBigInt::karatsubaScratch(size_t lhsSize, size_t rhsSize) {
+    if (lhsSize < rhsSize) {
+        std::swap(lhsSize, rhsSize);
+    }
+    if (rhsSize < thresholds.karatsuba) {
+        return 0;
+    }
+    size_t half = (lhsSize + 1) / 2;
+    if (rhsSize <= half) {                              // chunks of rhsSize limbs plus the last one
+        auto chunkScratch = [](size_t chunkSize, size_t rhs) {
+            return multiplyTier(chunkSize, rhs) <= TMultiplyTier::Karatsuba ? karatsubaScratch(chunkSize, rhs) : 0;
+        };
+        size_t last = lhsSize % rhsSize;
+        return std::max(2 * rhsSize + chunkScratch(rhsSize, rhsSize), last + rhsSize + chunkScratch(last, rhsSize));
+    }
+    return std::max({
+        karatsubaScratch(half, half),
+        karatsubaScratch(lhsSize - half, rhsSize - half),
+        4 * half + 4 + karatsubaScratch(half + 1, half + 1)
+    });
+}
+
+void TBigInt::karatsuba(uint32_t *res, TVector::TVectorView lhs, TVector::TVectorView rhs, uint32_t *scratch) {
+    if (lhs.size() < rhs.size()) {
+        std::swap(lhs, rhs);
+    }
+    size_t size = lhs.size() + rhs.size();
+    if (rhs.size() < thresholds.karatsuba) {
+        schoolbook(res, lhs, rhs);
+        return;
+    }
+    size_t half = (lhs.size() + 1) / 2;
+    if (rhs.size() <= half) {                           // unbalanced: multiply rhs by lhs chunk by chunk
+        auto [chunk, rest] = lhs.split(rhs.size());
+        karatsubaChunk(res, chunk, rhs, scratch);
+        for (size_t offset = chunk.size(); !rest.empty(); offset += chunk.size()) {
+            std::tie(chunk, rest) = rest.split(rhs.size());
+            size_t chunkSize = chunk.size() + rhs.size();
+            karatsubaChunk(scratch, chunk, rhs, scratch + chunkSize);
+            std::fill(res + offset + rhs.size(), res + offset + chunkSize, 0);
+            addInPlace(res + offset, chunkSize, { chunkSize, scratch });
+        }
+        return;
+    }
+    auto [lhs_first, lhs_second] = lhs.split(half);
+    auto [rhs_first, rhs_second] = rhs.split(half);
+    karatsuba(res, lhs_first, rhs_first, scratch);
+    karatsuba(res + 2 * half, lhs_second, rhs_second, scratch);
+
+    uint32_t *lhsSum = scratch, *rhsSum = scratch + half + 1, *med = scratch + 2 * half + 2;
+    lhsSum[half] = addLimbs(lhsSum, lhs_first, lhs_second);
+    rhsSum[half] = addLimbs(rhsSum, rhs_first, rhs_second);
+    TVector::TVectorView lhsSumView(half + lhsSum[half], lhsSum), rhsSumView(half + rhsSum[half], rhsSum);
+    size_t medSize = lhsSumView.size() + rhsSumView.size();
+    karatsuba(med, lhsSumView, rhsSumView, scratch + 4 * half + 4);
+    subInPlace(med, medSize, { 2 * half, res });
+    subInPlace(med, medSize, { size - 2 * half, res + 2 * half });
+    addInPlace(res + half, size - half, { std::min(medSize, size - half), med });   // limbs above are zero
+}
+
+// a chunk as long as rhs can be past the karatsuba range, multiply() gives it its own tier
+void TBigInt::karatsubaChunk(uint32_t *res, TVector::TVectorView chunk, TVector::TVectorView rhs, uint32_t *scratch) {
+    if (multiplyTier(chunk.size(), rhs.size()) <= TMultiplyTier::Karatsuba) {
+        karatsuba(res, chunk, rhs, scratch);
+    } else {
+        multiply(res, chunk, rhs);
+    }
+}
+
+void TBigInt::karatsubaSquare(uint32_t *res, TVector::TVectorView src, uint32_t *scratch) {
+    if (src.size() < thresholds.karatsuba) {
+        schoolbookSquare(res, src);
+        return;
+    }
+    size_t size = 2 * src.size(), half = (src.size() + 1) / 2;
+    auto [low, high] = src.split(half);
+    karatsubaSquare(res, low, scratch);
+    karatsubaSquare(res + 2 * half, high, scratch);
+
+    uint32_t *sum = scratch, *med = scratch + half + 1;
+    sum[half] = addLimbs(sum, low, high);
+    TVector::TVectorView sumView(half + sum[half], sum);
+    size_t medSize = 2 * sumView.size();
+    karatsubaSquare(med, sumView, scratch + 3 * half + 3);
+    subInPlace(med, medSize, { 2 * half, res });
+    subInPlace(med, medSize, { size - 2 * half, res + 2 * half });
+    addInPlace(res + half, size - half, { std::min(medSize, size - half), med });
+}
+
+TBigInt::TMultiplyTier TBigInt::multiplyTier(size_t lhsSize, size_t rhsSize) {
+    if (lhsSize < rhsSize) {
+        std::swap(lhsSize, rhsSize);
+    }
+    if (rhsSize >= thresholds.ntt && lhsSize + rhsSize <= nttMaxLength) {
+        return TMultiplyTier::Ntt;
+    } else if (rhsSize >= thresholds.toom4 && 4 * rhsSize > 3 * lhsSize) {
+        return TMultiplyTier::ToomCook4;
+    } else if (rhsSize >= thresholds.toom3 && 3 * rhsSize > 2 * lhsSize) {
+        return TMultiplyTier::ToomCook3;
+    }
+    return rhsSize < thresholds.karatsuba ? TMultiplyTier::Schoolbook : TMultiplyTier::Karatsuba;
+}
+
+void TBigInt::multiply(uint32_t *res, TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    if (lhs.size() < rhs.size()) {
+        std::swap(lhs, rhs);
+    }
+    size_t size = lhs.size() + rhs.size();
+    TMultiplyTier tier = multiplyTier(lhs.size(), rhs.size());
+    TVector product;
+    if (rhs.empty()) {
+        std::fill(res, res + size, 0);
+        return;
+    } else if (tier == TMultiplyTier::Ntt) {
+        product = nttMultiply(lhs, rhs);
+    } else if (tier == TMultiplyTier::ToomCook4) {
+        product = toomCook4(lhs, rhs);
+    } else if (tier == TMultiplyTier::ToomCook3) {
+        product = toomCook3(lhs, rhs);
+    } else if (pool && rhs.size() >= parallelLimbs) {
+        karatsubaParallel(res, lhs, rhs);
+        return;
+    } else {                                            // karatsuba over one reused workspace
+        thread_local TVector cache;
+        TVector scratch = std::move(cache);             // a chunk sent to toom or ntt lands here again and finds it taken
+        size_t scratchSize = karatsubaScratch(lhs.size(), rhs.size());
+        if (scratch.size() < scratchSize) {
+            scratch.resize_uninitialized(scratchSize);
         }
-        res[i] += rhs[i] * (i < rhs.size()) + carry;
-        if ((carry = res[i] >= TBigInt::base)) {        // -Werror=parentheses
-            res[i] -= TBigInt::base;
+        if (lhs.begin() == rhs.begin() && lhs.size() == rhs.size()) {
+            karatsubaSquare(res, lhs, scratch.begin());   // fits karatsubaScratch(n, n)
+        } else {
+            karatsuba(res, lhs, rhs, scratch.begin());
         }
+        cache = std::move(scratch);
+        return;
     }
-    return res;
+    std::copy(product.begin(), product.begin() + size, res);   // the tiers above leave one spare limb
 }
 
-TBigInt TBigInt::operator+(const TBigInt &obj) const {
-    if (neg != obj.neg) {
-        return neg ? obj - (-*this) : *this - (-obj);
+void TBigInt::karatsubaParallel(uint32_t *res, TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    size_t size = lhs.size() + rhs.size(), half = (lhs.size() + 1) / 2;   // lhs.size() >= rhs.size()
+    if (rhs.size() <= half) {                           // unbalanced: fork the lower chunks, keep the upper
+        size_t split = (lhs.size() / rhs.size() + 1) / 2 * rhs.size();
+        TVector::TVectorView low = lhs.split(split).first, high = lhs.split(split).second;   // named, lambdas cannot capture bindings
+        TThreadPool::TTask lowTask([&] { multiply(res, low, rhs); });
+        pool->submit(lowTask);
+        TVector upper;
+        upper.resize_uninitialized(high.size() + rhs.size());
+        multiply(upper.begin(), high, rhs);
+        pool->wait(lowTask);
+        std::fill(res + low.size() + rhs.size(), res + size, 0);
+        addInPlace(res + split, size - split, upper);
+        return;
+    }
+    TVector::TVectorView lhs_first = lhs.split(half).first, lhs_second = lhs.split(half).second;
+    TVector::TVectorView rhs_first = rhs.split(half).first, rhs_second = rhs.split(half).second;
+    bool square = lhs.begin() == rhs.begin() && lhs.size() == rhs.size();
+    TVector sums, med;
+    sums.resize_uninitialized(2 * half + 2);
+    uint32_t *lhsSum = sums.begin(), *rhsSum = sums.begin() + half + 1;
+    lhsSum[half] = addLimbs(lhsSum, lhs_first, lhs_second);
+    rhsSum[half] = addLimbs(rhsSum, rhs_first, rhs_second);
+    TVector::TVectorView lhsSumView(half + lhsSum[half], lhsSum);
+    TVector::TVectorView rhsSumView = square ? lhsSumView : TVector::TVectorView(half + rhsSum[half], rhsSum);
+    size_t medSize = lhsSumView.size() + rhsSumView.size();
+    med.resize_uninitialized(medSize);
+
+    TThreadPool::TTask lowTask([&] { multiply(res, lhs_first, rhs_first); });
+    TThreadPool::TTask highTask([&] { multiply(res + 2 * half, lhs_second, rhs_second); });
+    pool->submit(highTask);
+    pool->submit(lowTask);
+    multiply(med.begin(), lhsSumView, rhsSumView);
+    pool->wait(lowTask);
+    pool->wait(highTask);
+    subInPlace(med.begin(), medSize, { 2 * half, res });
+    subInPlace(med.begin(), medSize, { size - 2 * half, res + 2 * half });
+    addInPlace(res + half, size - half, { std::min(medSize, size - half), med.begin() });
+}
+
+void TBigInt::setThreads(size_t threads, size_t minLimbs) {
+    pool.reset(threads > 1 ? new TThreadPool(threads - 1) : nullptr);
+    parallelLimbs = std::max(minLimbs, thresholds.karatsuba);
+}
+
+TBigInt::TThresholds TBigInt::getThresholds() {
+    return thresholds;
+}
+
+void TBigInt::setThresholds(const TThresholds &obj) {
+    if (obj.karatsuba < 4) {
+        throw std::invalid_argument("TBigInt: halves of three limbs do not shrink, karatsuba needs 4");
+    } else if (obj.toom3 < 3 || obj.toom4 < 4) {
+        throw std::invalid_argument("TBigInt: toom-k needs at least k limbs");
+    } else if (obj.karatsuba > obj.toom3 || obj.toom3 > obj.toom4 || obj.toom4 > obj.ntt) {
+        throw std::invalid_argument("TBigInt: thresholds must grow with the tier, a lower one past a higher one never runs");
+    }
+    thresholds = obj;
+    parallelLimbs = std::max(parallelLimbs, thresholds.karatsuba);
+}
+
+// "karatsuba=32,toom3=900" applied over the given thresholds.
+static TBigInt::TThresholds parseThresholds(std::string_view spec, TBigInt::TThresholds res) {
+    constexpr std::pair<std::string_view, size_t TBigInt::TThresholds::*> tiers[] = {
+        { "karatsuba", &TBigInt::TThresholds::karatsuba },
+        { "toom3", &TBigInt::TThresholds::toom3 },
+        { "toom4", &TBigInt::TThresholds::toom4 },
+        { "ntt", &TBigInt::TThresholds::ntt }
+    };
+    while (!spec.empty()) {
+        std::string_view entry = spec.substr(0, spec.find(','));
+        spec.remove_prefix(std::min(spec.size(), entry.size() + 1));
+        std::string_view name = entry.substr(0, entry.find('=')), value = entry.substr(std::min(entry.size(), name.size() + 1));
+        auto tier = std::find_if(std::begin(tiers), std::end(tiers), [&](const auto &t) { return t.first == name; });
+        size_t limbs = 0;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), limbs);
+        if (tier == std::end(tiers) || value.empty() || ec != std::errc() || ptr != value.data() + value.size()) {
+            throw std::invalid_argument("TBigInt: bad BIGINT_THRESHOLDS entry '" + std::string(entry) + "'");
+        }
+        res.*tier->second = limbs;
     }
-    TBigInt res;
-    res.neg = neg;
-    res.data = this->data + obj.data;
     return res;
 }
 
+[[maybe_unused]] static const bool thresholdsFromEnvironment = [] {
+    const char *spec = std::getenv("BIGINT_THRESHOLDS");
+    try {
+        if (spec) {
+            TBigInt::setThresholds(parseThresholds(spec, TBigInt::getThresholds()));
+        }
+    } catch (const std::invalid_argument &e) {   // too early to throw anywhere useful
+        std::cerr << e.what() << ", keeping the built-in thresholds" << std::endl;
+        return false;
+    }
+    return spec != nullptr;
+}();
+
 TVector operator*(TVector::TVectorView lhs, TVector::TVectorView rhs) {
     TVector res;
-    res.resize(lhs.size() + rhs.size() + 1);
-    if (res.capacity() < 8) {                           // trivial
-        for (size_t i = 0; i < lhs.size(); ++i) {
-            for (size_t j = 0, carry = 0; j < rhs.size() || carry; ++j) {
-                uint32_t curr = res[i + j] + lhs[i] * rhs[j] + carry;
-                carry = curr / TBigInt::base;
-                res[i + j] = curr - carry * TBigInt::base;
-            }
-        }
-    } else {                                            // karatsuba
-        if (lhs.size() < rhs.size()) {
-            std::swap(lhs, rhs);
-        }
-        auto [lhs_first, lhs_second] = lhs.split();
-        auto [rhs_first, rhs_second] = rhs.split(lhs_first.size());
-        TVector product_1 = lhs_first * rhs_first;
-        TVector product_2 = lhs_second * rhs_second;
-        TVector product_3 = (lhs_first + lhs_second) * (rhs_first + rhs_second);
-        std::copy(product_1.begin(), product_1.end(), res.begin());
-        std::copy(product_2.begin(), product_2.end(), res.begin() + lhs_first.size() + rhs_first.size());
-        TVector med = product_3 - (product_1 + product_2);
-        med = med + TVector::TVectorView(med.size(), res.begin() + lhs_first.size());
-        std::copy(med.begin(), med.end(), res.begin() + lhs_first.size());
+    if (lhs.empty() || rhs.empty()) {
+        return res;
     }
+    res.resize_uninitialized(lhs.size() + rhs.size());
+    TBigInt::multiply(res.begin(), lhs, rhs);
     TBigInt::removeLeadingZeros(res);
     return res;
 }
@@ -215,40 +716,557 @@ TBigInt TBigInt::operator*(const TBigInt &obj) const {
     return res;
 }
 
+TBigInt& TBigInt::operator+=(const TBigInt &obj) {
+    if (neg == obj.neg) {
+        addMagnitude(obj.data);
+    } else {
+        subMagnitude(obj.data);
+    }
+    return *this;
+}
+
+TBigInt& TBigInt::operator-=(const TBigInt &obj) {
+    if (neg != obj.neg) {
+        addMagnitude(obj.data);
+    } else {
+        subMagnitude(obj.data);
+    }
+    return *this;
+}
+
+void TBigInt::accumulateProduct(const TBigInt &lhs, const TBigInt &rhs, bool subtract) {
+    if (lhs.data.empty() || rhs.data.empty()) {
+        return;
+    }
+    bool negative = (lhs.neg != rhs.neg) != subtract;
+    TVector::TVectorView longer(lhs.data), shorter(rhs.data);
+    if (longer.size() < shorter.size()) {
+        std::swap(longer, shorter);
+    }
+    size_t size = longer.size() + shorter.size();
+    if (data.empty()) {                                 // the product is the sum, lhs and rhs cannot be *this
+        data.resize_uninitialized(size);
+        multiply(data.begin(), longer, shorter);
+        removeLeadingZeros(data);
+        neg = negative;
+    } else if (neg == negative && shorter.size() < thresholds.karatsuba && &lhs != this && &rhs != this) {
+        data.resize(std::max(data.size(), size) + 1);   // schoolbook rows straight into the sum
+        for (size_t i = 0; i < shorter.size(); ++i) {
+            size_t end = i + longer.size();
+            uint32_t carry = addMul1(data.begin() + i, longer.begin(), longer.size(), shorter.begin()[i]);
+            add1(data.begin() + end, data.begin() + end, data.size() - end, carry);
+        }
+        removeLeadingZeros(data);
+    } else {
+        thread_local TVector product;
+        product.resize_uninitialized(size);
+        multiply(product.begin(), longer, shorter);
+        removeLeadingZeros(product);
+        if (neg == negative) {
+            addMagnitude(product);
+        } else {
+            subMagnitude(product);
+        }
+    }
+}
+
+TBigInt& TBigInt::addProduct(const TBigInt &lhs, const TBigInt &rhs) {
+    accumulateProduct(lhs, rhs, false);
+    return *this;
+}
+
+TBigInt& TBigInt::subProduct(const TBigInt &lhs, const TBigInt &rhs) {
+    accumulateProduct(lhs, rhs, true);
+    return *this;
+}
+
+TBigInt& TBigInt::operator*=(const TBigInt &obj) {
+    data = data * obj.data;
+    neg = data.empty() ? false : neg != obj.neg;
+    return *this;
+}
+
+size_t TBigInt::bitLength() const {
+    return data.empty() ? 0 : limbBits * data.size() - __builtin_clz(data.back());
+}
+
+TBigInt TBigInt::operator<<(size_t bits) const {
+    TBigInt res;
+    if (data.empty()) {
+        return res;
+    }
+    res.neg = neg;
+    res.data = shiftLeftBits(data, bits);
+    removeLeadingZeros(res.data);
+    return res;
+}
+
+TBigInt TBigInt::operator>>(size_t bits) const {
+    size_t limbs = bits / limbBits, shift = bits % limbBits;
+    if (limbs >= data.size()) {
+        return neg ? -TBigInt(1) : TBigInt();
+    }
+    TBigInt res;
+    res.data = shiftRightBits(data, bits);
+    bool inexact = shift && data[limbs] << (limbBits - shift);
+    for (size_t i = 0; !inexact && i < limbs; ++i) {
+        inexact = data[i];
+    }
+    res.neg = res.data.empty() ? false : neg;
+    if (neg && inexact) {
+        --res;
+    }
+    return res;
+}
+
+TBigInt& TBigInt::operator<<=(size_t bits) {
+    return *this = *this << bits;
+}
+
+TBigInt& TBigInt::operator>>=(size_t bits) {
+    return *this = *this >> bits;
+}
+
+TBigInt& TBigInt::operator++() {
+    const uint32_t one = 1;
+    if (neg) {
+        subMagnitude({ 1, &one });
+    } else {
+        addMagnitude({ 1, &one });
+    }
+    return *this;
+}
+
+TBigInt& TBigInt::operator--() {
+    const uint32_t one = 1;
+    if (neg) {
+        addMagnitude({ 1, &one });
+    } else {
+        subMagnitude({ 1, &one });
+    }
+    return *this;
+}
+
+TBigInt TBigInt::operator++(int) {
+    TBigInt res = *this;
+    ++*this;
+    return res;
+}
+
+TBigInt TBigInt::operator--(int) {
+    TBigInt res = *this;
+    --*this;
+    return res;
+}
+
+std::pair<TVector, TVector> TBigInt::divModSchoolbook(TVector::TVectorView num, TVector::TVectorView den) {
+    TVector quot, rem;
+    if (num.size() < den.size()) {
+        rem = num;
+        removeLeadingZeros(rem);
+        return { std::move(quot), std::move(rem) };
+    } else if (den.size() == 1) {
+        quot = num;
+        uint32_t last = divModWord(quot, den[0]);
+        if (last) {
+            rem.push_back(last);
+        }
+        return { std::move(quot), std::move(rem) };
+    }
+    size_t size = den.size(), shift = __builtin_clz(den.end()[-1]);   // knuth's algorithm d
+    TVector divisor = shiftLeftBits(den, shift), rest = shiftLeftBits(num, shift);
+    uint64_t top = divisor[size - 1], next = divisor[size - 2];
+    quot.resize_uninitialized(num.size() - size + 1);
+    for (size_t j = quot.size(); j--; ) {
+        uint64_t curr = static_cast<uint64_t>(rest[j + size]) << limbBits | rest[j + size - 1];
+        uint64_t guess = curr / top, remainder = curr % top;
+        while (guess >> limbBits || guess * next > (remainder << limbBits | rest[j + size - 2])) {
+            --guess;
+            remainder += top;
+            if (remainder >> limbBits) {
+                break;
+            }
+        }
+        uint32_t borrow = subMul1(rest.begin() + j, divisor.begin(), size, static_cast<uint32_t>(guess));
+        uint32_t high = rest[j + size];
+        rest[j + size] = high - borrow;
+        if (high < borrow) {                            // guess was one too large
+            --guess;
+            rest[j + size] += addN(rest.begin() + j, rest.begin() + j, divisor.begin(), size);
+        }
+        quot[j] = guess;
+    }
+    removeLeadingZeros(quot);
+    rem = shiftRightBits({ size, rest.begin() }, shift);
+    return { std::move(quot), std::move(rem) };
+}
+
+std::pair<TBigInt, TBigInt> TBigInt::divide2n1n(const TBigInt &num, const TBigInt &den, size_t len) {
+    if (len & 1 || len < burnikelZieglerThreshold) {
+        auto [quot, rem] = divModSchoolbook(num.data, den.data);
+        return { TBigInt(quot), TBigInt(rem) };
+    }
+    auto [low, high] = TVector::TVectorView(num.data).split(len / 2);
+    auto [quotHigh, remHigh] = divide3n2n(TBigInt(high), den, len / 2);
+    auto [quotLow, rem] = divide3n2n(remHigh.shiftLimbs(len / 2) + TBigInt(low), den, len / 2);
+    return { quotHigh.shiftLimbs(len / 2) + quotLow, std::move(rem) };
+}
+
+std::pair<TBigInt, TBigInt> TBigInt::divide3n2n(const TBigInt &num, const TBigInt &den, size_t len) {
+    auto [denLow, denHigh] = TVector::TVectorView(den.data).split(len);
+    auto [numLow, numHigh] = TVector::TVectorView(num.data).split(len);
+    TBigInt high(denHigh), quot, rest;
+    if (TBigInt(numHigh.split(len).second) < high) {
+        std::tie(quot, rest) = divide2n1n(TBigInt(numHigh), high, len);
+    } else {                                            // the quotient limb block saturates
+        quot.data.resize_uninitialized(len);
+        std::fill(quot.data.begin(), quot.data.end(), ~0u);
+        rest = TBigInt(numHigh) - high.shiftLimbs(len) + high;
+    }
+    rest = rest.shiftLimbs(len) + TBigInt(numLow) - quot * TBigInt(denLow);
+    while (rest.neg) {
+        quot = quot - 1;
+        rest = rest + den;
+    }
+    return { std::move(quot), std::move(rest) };
+}
+
+std::pair<TVector, TVector> TBigInt::divModBurnikelZiegler(TVector::TVectorView num, TVector::TVectorView den) {
+    size_t blocks = 1;
+    while (blocks * burnikelZieglerThreshold <= den.size()) {
+        blocks <<= 1;
+    }
+    size_t len = (den.size() + blocks - 1) / blocks * blocks;
+    size_t shift = limbBits * len - ::bitLength(den);   // the divisor gets exactly len limbs, top bit set
+    TBigInt divisor(shiftLeftBits(den, shift));
+    TVector dividend = shiftLeftBits(num, shift);
+    size_t parts = std::max<size_t>(2, (::bitLength(dividend) + limbBits * len) / (limbBits * len));
+
+    TVector quot;
+    quot.resize((parts - 1) * len);
+    TBigInt rest(TVector::TVectorView(dividend).split((parts - 2) * len).second);
+    for (size_t i = parts - 1; i--; ) {
+        auto [quotPart, remPart] = divide2n1n(rest, divisor, len);
+        std::copy(quotPart.data.begin(), quotPart.data.end(), quot.begin() + i * len);
+        if (!i) {
+            rest = std::move(remPart);
+            break;
+        }
+        auto [low, high] = TVector::TVectorView(dividend).split((i - 1) * len);
+        rest = remPart.shiftLimbs(len) + TBigInt(high.split(len).first);
+    }
+    removeLeadingZeros(quot);
+    return { std::move(quot), shiftRightBits(rest.data, shift) };
+}
+
+std::pair<TVector, TVector> TBigInt::divModMagnitude(TVector::TVectorView num, TVector::TVectorView den) {
+    if (den.size() < burnikelZieglerThreshold || num.size() < den.size() + burnikelZieglerThreshold) {
+        return divModSchoolbook(num, den);
+    }
+    return divModBurnikelZiegler(num, den);
+}
+
+std::pair<TBigInt, TBigInt> TBigInt::divmodSigned(const TBigIntView &lhs, const TBigIntView &rhs) {
+    if (rhs.limbs().empty()) {
+        throw std::domain_error("TBigInt: division by zero");
+    }
+    auto [quot, rem] = divModMagnitude(lhs.limbs(), rhs.limbs());
+    return { TBigInt(quot, lhs.negative() != rhs.negative()), TBigInt(rem, lhs.negative()) };
+}
+
+std::pair<TBigInt, TBigInt> TBigInt::divmod(const TBigInt &obj) const {
+    return divmodSigned(*this, obj);
+}
+
+TBigInt TBigInt::square() const {
+    TBigInt res;
+    res.data = data * data;                             // identical views pick the squaring kernels
+    return res;
+}
+
+TBigInt TBigInt::operator/(const TBigInt &obj) const {
+    return divmod(obj).first;
+}
+
+TBigInt TBigInt::operator%(const TBigInt &obj) const {
+    return divmod(obj).second;
+}
+
+TVector::TVectorView TBigInt::decimalPower(size_t level) {
+    thread_local std::deque<TVector> powers;            // a deque keeps the views of the smaller powers valid
+    if (powers.empty()) {
+        powers.push_back({ decimalBase });
+    }
+    while (powers.size() <= level) {
+        powers.push_back(powers.back() * powers.back());
+    }
+    return powers[level];
+}
+
+void TBigInt::decimalChunks(TVector::TVectorView num, size_t level, uint32_t *chunks) {
+    size_t count = size_t(1) << level;
+    if (level <= decimalLeafLevel) {                    // divided down by 10^9 one chunk at a time
+        TVector rest(num);
+        size_t size = rest.size(), i = 0;
+        for (; size; ++i) {
+            uint64_t rem = 0;
+            for (size_t j = size; j--; ) {
+                uint64_t curr = rem << limbBits | rest[j];
+                rest[j] = static_cast<uint32_t>(curr / decimalBase);
+                rem = curr % decimalBase;
+            }
+            chunks[i] = static_cast<uint32_t>(rem);
+            size -= !rest[size - 1];    // a division by 10^9 drops at most one limb
+        }
+        std::fill(chunks + i, chunks + count, 0);
+        return;
+    }
+    TVector::TVectorView power = decimalPower(level - 1);
+    if (num.size() < power.size()) {
+        decimalChunks(num, level - 1, chunks);
+        std::fill(chunks + count / 2, chunks + count, 0);
+        return;
+    }
+    auto [quot, rem] = divModMagnitude(num, power);
+    decimalChunks(rem, level - 1, chunks);
+    decimalChunks(quot, level - 1, chunks + count / 2);
+}
+
+TVector::TVectorView TBigInt::decimalChunks(TVector::TVectorView src) {
+    // split by 10^(9 * 2^k) down to the leaves, base 10^9 chunks come out least significant first
+    thread_local TVector scratch;
+    size_t chunksMax = src.size() + src.size() / 8 + 1, level = 0;
+    for (; (size_t(1) << level) < chunksMax; ++level) {}
+    if (scratch.size() < (size_t(1) << level)) {
+        scratch.resize_uninitialized(size_t(1) << level);
+    }
+    decimalChunks(src, level, scratch.begin());
+    size_t count = size_t(1) << level;
+    while (count > 1 && !scratch[count - 1]) {
+        --count;
+    }
+    return TVector::TVectorView(count, scratch.begin());
+}
+
+TVector TBigInt::parseDecimal(const char *first, const char *last) {
+    constexpr uint32_t powersOfTen[] = {
+        1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000, 1'000'000'000
+    };
+    size_t count = last - first, leafDigits = static_cast<size_t>(digitShift) << decimalLeafLevel;
+    TVector res;
+    if (count <= leafDigits) {                          // chunks of 9 digits multiplied in one at a time
+        res.reserve(count / digitShift + 1);
+        for (size_t len = (count - 1) % digitShift + 1; first != last; first += len, len = digitShift) {
+            uint32_t chunk = 0;
+            for (size_t i = 0; i < len; ++i) {
+                chunk = chunk * 10 + (first[i] - '0');
+            }
+            mulAddWord(res, powersOfTen[len], chunk);
+        }
+        return res;
+    }
+    size_t level = decimalLeafLevel;
+    while ((static_cast<size_t>(digitShift) << (level + 1)) < count) {
+        ++level;
+    }
+    const char *split = last - (static_cast<size_t>(digitShift) << level);   // the low part is 10^(9 * 2^level) at most
+    TVector high = parseDecimal(first, split), low = parseDecimal(split, last);
+    if (high.empty()) {
+        return low;
+    }
+    TVector::TVectorView power = decimalPower(level);
+    res.resize_uninitialized(high.size() + power.size());
+    multiply(res.begin(), high, power);
+    addInPlace(res.begin(), res.size(), low);
+    removeLeadingZeros(res);
+    return res;
+}
+
+static size_t digitCount(uint32_t val) {
+    size_t count = 1;
+    for (; val >= 10; val /= 10) {
+        ++count;
+    }
+    return count;
+}
+
+static char* writeDigits(char *out, uint32_t val, size_t width) {
+    for (size_t i = width; i--; val /= 10) {
+        out[i] = static_cast<char>('0' + val % 10);
+    }
+    return out + width;
+}
+
+std::to_chars_result to_chars(char *first, char *last, const TBigInt &obj) {
+    if (obj.data.empty()) {
+        if (first == last) {
+            return { last, std::errc::value_too_large };
+        }
+        *first = '0';
+        return { first + 1, std::errc() };
+    }
+    TVector::TVectorView chunks = TBigInt::decimalChunks(obj.data);
+    size_t top = digitCount(chunks[chunks.size() - 1]);
+    size_t len = obj.neg + top + (chunks.size() - 1) * TBigInt::digitShift;
+    if (static_cast<size_t>(last - first) < len) {
+        return { last, std::errc::value_too_large };
+    }
+    if (obj.neg) {
+        *first++ = '-';
+    }
+    first = writeDigits(first, chunks[chunks.size() - 1], top);
+    for (size_t i = chunks.size() - 1; i--; ) {
+        first = writeDigits(first, chunks[i], TBigInt::digitShift);
+    }
+    return { first, std::errc() };
+}
+
+std::from_chars_result from_chars(const char *first, const char *last, TBigInt &obj) {
+    const char *digits = first + (first != last && (*first == '-' || *first == '+'));
+    const char *end = digits;
+    while (end != last && isdigit(static_cast<unsigned char>(*end))) {
+        ++end;
+    }
+    if (end == digits) {
+        return { first, std::errc::invalid_argument };
+    }
+    obj.data = TBigInt::parseDecimal(digits, end);
+    obj.neg = obj.data.empty() ? false : *first == '-';
+    return { end, std::errc() };
+}
+
 std::istream& operator>>(std::istream &is, TBigInt &obj) {
     obj.clear();
-    std::streamoff pos = (is >> std::ws).tellg();
-    int32_t ch = is.peek();
-    if (ch == EOF) {
+    std::istream::sentry sentry(is);
+    if (!sentry) {
         return is;
     }
-    std::string str;
+    // the digits are gathered straight from the stream buffer into a reused text buffer
+    thread_local std::string text;
+    text.clear();
+    std::streambuf *buf = is.rdbuf();
+    int32_t ch = buf->sgetc();
     if (ch == '-' || ch == '+') {
-        is.ignore(1);
-        str.push_back(ch);
+        text.push_back(static_cast<char>(ch));
+        ch = buf->snextc();
     }
-    if (!isdigit(is.peek())) {
-        is.seekg(pos);
-        is.setstate(std::istream::failbit);
-        return is;
+    for (; isdigit(ch); ch = buf->snextc()) {
+        text.push_back(static_cast<char>(ch));
     }
-    while (isdigit(ch = is.peek())) {
-        str.push_back(ch);
-        is.ignore(1);
+    if (ch == EOF) {
+        is.setstate(std::istream::eofbit);
+    }
+    if (from_chars(text.data(), text.data() + text.size(), obj).ec != std::errc()) {
+        if (!text.empty()) {
+            buf->sungetc();
+        }
+        is.setstate(std::istream::failbit);
     }
-    obj.readBigInt(str);
     return is;
 }
 
 std::ostream& operator<<(std::ostream &os, const TBigInt &obj) {
-    if (obj.data.empty()) {
-        return os << 0;
-    } else if (obj.neg) {
-        os << '-';
+    std::ostream::sentry sentry(os);
+    if (!sentry) {
+        return os;
+    }
+    // a limb never takes more than 10 decimal digits; one more for the sign or a lone zero
+    thread_local std::string text;
+    size_t limit = obj.data.size() * 10 + 2;
+    if (text.size() < limit) {
+        text.resize(limit);
+    }
+    std::streamsize len = to_chars(text.data(), text.data() + text.size(), obj).ptr - text.data();
+    if (os.rdbuf()->sputn(text.data(), len) != len) {
+        os.setstate(std::ostream::badbit);
     }
-    os << obj.data.back() << std::setfill('0');
-    for (size_t i = obj.data.size() - 1; i--; os << obj.data[i]) {
-        os << std::setw(TBigInt::digitShift);
+    os.width(0);
+    return os;
+}
+
+TBigIntView::TBigIntView() : neg(false), data(0, nullptr) {}
+
+TBigIntView::TBigIntView(const TBigInt &obj) : neg(obj.neg), data(obj.data) {}
+
+TBigIntView::TBigIntView(TVector::TVectorView limbs, bool negative) : neg(negative && !limbs.empty()), data(limbs) {}
+
+TBigIntView::TBigIntView(const TBigIntView &obj) : neg(obj.neg), data(obj.data) {}
+
+TBigIntView& TBigIntView::operator=(const TBigIntView &obj) {
+    neg = obj.neg;
+    data = TVector::TVectorView(obj.data);
+    return *this;
+}
+
+bool TBigIntView::negative() const {
+    return neg;
+}
+
+TVector::TVectorView TBigIntView::limbs() const {
+    return data;
+}
+
+TBigInt TBigIntView::value() const {
+    return TBigInt(*this);
+}
+
+TBigIntView TBigIntView::operator-() const {
+    return TBigIntView(data, !neg);
+}
+
+TBigInt operator+(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return TBigInt::addSigned(lhs, rhs);
+}
+
+TBigInt operator-(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return TBigInt::addSigned(lhs, -rhs);
+}
+
+TBigInt operator*(const TBigIntView &lhs, const TBigIntView &rhs) {
+    TBigInt res;
+    if (!lhs.data.empty() && !rhs.data.empty()) {
+        res.neg = lhs.neg != rhs.neg;
+        res.data = lhs.data * rhs.data;
     }
-    return os << std::setfill(' ');
+    return res;
+}
+
+TBigInt operator/(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return TBigInt::divmodSigned(lhs, rhs).first;
+}
+
+TBigInt operator%(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return TBigInt::divmodSigned(lhs, rhs).second;
+}
+
+static int compareSigned(const TBigIntView &lhs, const TBigIntView &rhs) {
+    if (lhs.negative() != rhs.negative()) {
+        return lhs.negative() ? -1 : 1;
+    }
+    int res = compareMagnitude(lhs.limbs(), rhs.limbs());
+    return lhs.negative() ? -res : res;
+}
+
+bool operator<(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return compareSigned(lhs, rhs) < 0;
+}
+
+bool operator>(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return compareSigned(lhs, rhs) > 0;
+}
+
+bool operator==(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return !compareSigned(lhs, rhs);
+}
+
+bool operator!=(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return compareSigned(lhs, rhs) != 0;
+}
+
+bool operator<=(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return compareSigned(lhs, rhs) <= 0;
+}
+
+bool operator>=(const TBigIntView &lhs, const TBigIntView &rhs) {
+    return compareSigned(lhs, rhs) >= 0;
 }
@@ -1,35 +1,139 @@
 #pragma once
 
+#include "thresholds.h"
 #include "vector.h"
 
+#include <charconv>
 #include <iostream>
+#include <type_traits>
 
 std::string_view strip(std::string_view);
 
+TVector operator*(TVector::TVectorView, TVector::TVectorView);
+
+template <size_t> struct TExpression;
+class TBigIntView;
+
+// Machine integers of any width and signedness take the single word paths below.
+template <class T>
+using TIfWord = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int>;
+
+template <class T>
+constexpr bool wordNegative(T val) {
+    if constexpr (std::is_signed_v<T>) {
+        return val < 0;
+    }
+    return false;
+}
+
+template <class T>
+constexpr uint64_t wordMagnitude(T val) {
+    return wordNegative(val) ? 0 - static_cast<uint64_t>(val) : static_cast<uint64_t>(val);
+}
+
 class TBigInt {
+public:
+    // Limbs of the shorter operand where each multiplication tier starts.
+    struct TThresholds {
+        size_t karatsuba = tunedKaratsubaThreshold;
+        size_t toom3 = tunedToom3Threshold;
+        size_t toom4 = tunedToom4Threshold;
+        size_t ntt = tunedNttThreshold;
+    };
+
+    enum class TMultiplyTier {
+        Schoolbook,
+        Karatsuba,
+        ToomCook3,
+        ToomCook4,
+        Ntt
+    };
 private:
-    constexpr static int32_t digitShift = 4;
+    constexpr static int32_t digitShift = 9;           // decimal digits per chunk at the I/O edge
+    constexpr static uint32_t decimalBase = 1'000'000'000;
+    constexpr static size_t decimalLeafLevel = 4;       // 2^4 chunks of 10^9 are converted one chunk at a time
+    constexpr static size_t burnikelZieglerThreshold = 80;
+    constexpr static size_t parallelThreshold = 256;    // default limbs of the shorter operand to fork
+
+    static TThresholds thresholds;
 
     bool neg;
     TVector data;
 
-    void readBigInt(std::string_view);
+    explicit TBigInt(TVector::TVectorView, bool = false);
+
+    void addMagnitude(TVector::TVectorView);
+    void subMagnitude(TVector::TVectorView);
+    void accumulateProduct(const TBigInt&, const TBigInt&, bool);
+    TBigInt shiftLimbs(size_t) const;
+    void assignWord(uint64_t, bool);
+    uint64_t lowWord() const;                           // the magnitude modulo 2^64
+    TBigInt& addWord(uint64_t, bool);
+    TBigInt& mulWord(uint64_t, bool = false);
+    uint64_t divWord(uint64_t, bool);                   // in place, returns the magnitude of the remainder
+    TBigInt& divExactWord(uint32_t);
+    static TBigInt addSigned(const TBigIntView&, const TBigIntView&);
+
+    static void multiply(uint32_t*, TVector::TVectorView, TVector::TVectorView);
+    static size_t karatsubaScratch(size_t, size_t);
+    static void karatsuba(uint32_t*, TVector::TVectorView, TVector::TVectorView, uint32_t*);
+    static void karatsubaChunk(uint32_t*, TVector::TVectorView, TVector::TVectorView, uint32_t*);
+    static void karatsubaSquare(uint32_t*, TVector::TVectorView, uint32_t*);
+    static void karatsubaParallel(uint32_t*, TVector::TVectorView, TVector::TVectorView);
+    static std::pair<TBigInt, TBigInt> evaluate(std::initializer_list<TVector::TVectorView>, uint32_t);
+    static TVector toomCook3(TVector::TVectorView, TVector::TVectorView);
+    static TVector toomCook4(TVector::TVectorView, TVector::TVectorView);
+
+    static TVector::TVectorView decimalPower(size_t);   // 10^(9 * 2^level)
+    static void decimalChunks(TVector::TVectorView, size_t, uint32_t*);
+    static TVector::TVectorView decimalChunks(TVector::TVectorView);
+    static TVector parseDecimal(const char*, const char*);
+
+    static std::pair<TVector, TVector> divModSchoolbook(TVector::TVectorView, TVector::TVectorView);
+    static std::pair<TVector, TVector> divModBurnikelZiegler(TVector::TVectorView, TVector::TVectorView);
+    static std::pair<TVector, TVector> divModMagnitude(TVector::TVectorView, TVector::TVectorView);
+    static std::pair<TBigInt, TBigInt> divide2n1n(const TBigInt&, const TBigInt&, size_t);
+    static std::pair<TBigInt, TBigInt> divide3n2n(const TBigInt&, const TBigInt&, size_t);
+    static std::pair<TBigInt, TBigInt> divmodSigned(const TBigIntView&, const TBigIntView&);
 public:
-    constexpr static uint32_t base = 10'000;
-    constexpr static uint32_t signBit = 1u << 31;
+    constexpr static uint32_t limbBits = 32;
+    constexpr static uint64_t base = 1ull << limbBits;
 
     TBigInt();
-    TBigInt(uint32_t);
+    template <class T, TIfWord<T> = 0>
+    TBigInt(T);
     explicit TBigInt(std::string_view);
     TBigInt(const TBigInt&);
     TBigInt(TBigInt&&);
+    explicit TBigInt(const TBigIntView&);
+    template <size_t N>
+    TBigInt(const TExpression<N>&);                     // see expression.h
 
     static bool removeLeadingZeros(TVector&);
+    size_t bitLength() const;                           // of the magnitude, 0 for zero
+    // Opt-in: with more than one thread, karatsuba levels whose shorter operand has at least
+    // the given number of limbs fork their sub-products to a pool. Not safe to call while
+    // other threads multiply.
+    static void setThreads(size_t, size_t = parallelThreshold);
+    // The tiers start from thresholds.h, BIGINT_THRESHOLDS="karatsuba=32,toom3=900" in the
+    // environment replaces the named ones at startup. Same caveat as setThreads, and
+    // invalid_argument for a karatsuba threshold below 4, toom ones below 3 and 4, or
+    // thresholds that do not grow with the tier: each tier is tried before the ones below
+    // it, so a lower one past it would never run. Equal thresholds switch the lower tier off.
+    static TThresholds getThresholds();
+    static void setThresholds(const TThresholds&);
+    static TMultiplyTier multiplyTier(size_t, size_t);  // the tier a product of these sizes starts in
     void clear();
 
-    TBigInt& operator=(uint32_t);
+    template <class T, TIfWord<T> = 0>
+    TBigInt& operator=(T);
     TBigInt& operator=(const TBigInt&);
     TBigInt& operator=(TBigInt&&);
+    template <size_t N>
+    TBigInt& operator=(const TExpression<N>&);
+
+    template <class T, TIfWord<T> = 0>
+    explicit operator T() const;                        // wraps modulo 2^bits like the builtin conversions
 
     bool operator<(const TBigInt&) const;
     bool operator>(const TBigInt&) const;
@@ -42,7 +146,167 @@ public:
     TBigInt operator-(const TBigInt&) const;
     TBigInt operator+(const TBigInt&) const;
     TBigInt operator*(const TBigInt&) const;
+    TBigInt square() const;
+    TBigInt operator/(const TBigInt&) const;
+    TBigInt operator%(const TBigInt&) const;
+    TBigInt operator<<(size_t) const;
+    TBigInt operator>>(size_t) const;                   // rounds towards minus infinity
+
+    std::pair<TBigInt, TBigInt> divmod(const TBigInt&) const;
+
+    // A word operand is used in place: one pass over the limbs and no temporary for it.
+    // divmod truncates like the above, an unsigned remainder type gets the magnitude.
+    template <class T, TIfWord<T> = 0>
+    TBigInt operator+(T) const;
+    template <class T, TIfWord<T> = 0>
+    TBigInt operator-(T) const;
+    template <class T, TIfWord<T> = 0>
+    TBigInt operator*(T) const;
+    template <class T, TIfWord<T> = 0>
+    std::pair<TBigInt, T> divmod(T) const;
+    template <class T, TIfWord<T> = 0>
+    TBigInt& operator+=(T);
+    template <class T, TIfWord<T> = 0>
+    TBigInt& operator-=(T);
+    template <class T, TIfWord<T> = 0>
+    TBigInt& operator*=(T);
 
+    TBigInt& operator+=(const TBigInt&);
+    TBigInt& operator-=(const TBigInt&);
+    TBigInt& operator*=(const TBigInt&);
+    TBigInt& operator<<=(size_t);
+    TBigInt& operator>>=(size_t);
+    TBigInt& addProduct(const TBigInt&, const TBigInt&);    // *this += lhs * rhs without a temporary
+    TBigInt& subProduct(const TBigInt&, const TBigInt&);
+    TBigInt& operator++();
+    TBigInt& operator--();
+    TBigInt operator++(int);
+    TBigInt operator--(int);
+
+    friend TVector operator*(TVector::TVectorView, TVector::TVectorView);
+    friend TBigInt powmod(const TBigInt&, const TBigInt&, const TBigInt&);
+    friend class TMontgomery;
+    friend class TBigIntAccumulator;
+    friend class TBigIntView;
+    friend class TGcd;
+    friend TBigInt operator+(const TBigIntView&, const TBigIntView&);
+    friend TBigInt operator-(const TBigIntView&, const TBigIntView&);
+    friend TBigInt operator*(const TBigIntView&, const TBigIntView&);
+    friend TBigInt operator/(const TBigIntView&, const TBigIntView&);
+    friend TBigInt operator%(const TBigIntView&, const TBigIntView&);
+    friend std::from_chars_result fromBinary(const char*, const char*, TBigInt&);
+    friend bool readBinary(std::istream&, TBigInt&);
+    friend std::to_chars_result to_chars(char*, char*, const TBigInt&);
+    friend std::from_chars_result from_chars(const char*, const char*, TBigInt&);
     friend std::istream& operator>>(std::istream&, TBigInt&);
     friend std::ostream& operator<<(std::ostream&, const TBigInt&);
 };
+
+// Same contract as the std:: overloads: value_too_large leaves [first, last) unspecified,
+// invalid_argument leaves the target untouched. An optional leading '+' is accepted.
+std::to_chars_result to_chars(char*, char*, const TBigInt&);
+std::from_chars_result from_chars(const char*, const char*, TBigInt&);
+
+// Read-only number over limbs it does not own: a TBigInt, a record of a mapped file or
+// a literal. The limbs have to outlive the view and must not have leading zeros.
+class TBigIntView {
+private:
+    bool neg;
+    TVector::TVectorView data;
+
+    friend TBigInt operator*(const TBigIntView&, const TBigIntView&);
+public:
+    TBigIntView();
+    TBigIntView(const TBigInt&);
+    TBigIntView(TVector::TVectorView, bool);
+    TBigIntView(const TBigIntView&);
+    TBigIntView& operator=(const TBigIntView&);
+
+    bool negative() const;
+    TVector::TVectorView limbs() const;
+    TBigInt value() const;                              // copies the limbs
+
+    TBigIntView operator-() const;
+};
+
+// Views mix with each other and with TBigInt operands, so x + 5_big, n % p_big and 2_big < n
+// work without copying the literal.
+TBigInt operator+(const TBigIntView&, const TBigIntView&);
+TBigInt operator-(const TBigIntView&, const TBigIntView&);
+TBigInt operator*(const TBigIntView&, const TBigIntView&);
+TBigInt operator/(const TBigIntView&, const TBigIntView&);
+TBigInt operator%(const TBigIntView&, const TBigIntView&);
+bool operator<(const TBigIntView&, const TBigIntView&);
+bool operator>(const TBigIntView&, const TBigIntView&);
+bool operator==(const TBigIntView&, const TBigIntView&);
+bool operator!=(const TBigIntView&, const TBigIntView&);
+bool operator<=(const TBigIntView&, const TBigIntView&);
+bool operator>=(const TBigIntView&, const TBigIntView&);
+
+template <class T, TIfWord<T>>
+TBigInt::TBigInt(T val) : neg(), data() {
+    assignWord(wordMagnitude(val), wordNegative(val));
+}
+
+template <class T, TIfWord<T>>
+TBigInt& TBigInt::operator=(T val) {
+    assignWord(wordMagnitude(val), wordNegative(val));
+    return *this;
+}
+
+template <class T, TIfWord<T>>
+TBigInt::operator T() const {
+    return static_cast<T>(neg ? 0 - lowWord() : lowWord());
+}
+
+template <class T, TIfWord<T>>
+TBigInt TBigInt::operator+(T val) const {
+    return TBigInt(*this).addWord(wordMagnitude(val), wordNegative(val));
+}
+
+template <class T, TIfWord<T>>
+TBigInt TBigInt::operator-(T val) const {
+    return TBigInt(*this).addWord(wordMagnitude(val), !wordNegative(val));
+}
+
+template <class T, TIfWord<T>>
+TBigInt TBigInt::operator*(T val) const {
+    return TBigInt(*this).mulWord(wordMagnitude(val), wordNegative(val));
+}
+
+template <class T, TIfWord<T>>
+std::pair<TBigInt, T> TBigInt::divmod(T val) const {
+    TBigInt quot = *this;
+    T rem = static_cast<T>(quot.divWord(wordMagnitude(val), wordNegative(val)));
+    return { std::move(quot), std::is_signed_v<T> && neg ? static_cast<T>(0 - rem) : rem };
+}
+
+template <class T, TIfWord<T>>
+TBigInt& TBigInt::operator+=(T val) {
+    return addWord(wordMagnitude(val), wordNegative(val));
+}
+
+template <class T, TIfWord<T>>
+TBigInt& TBigInt::operator-=(T val) {
+    return addWord(wordMagnitude(val), !wordNegative(val));
+}
+
+template <class T, TIfWord<T>>
+TBigInt& TBigInt::operator*=(T val) {
+    return mulWord(wordMagnitude(val), wordNegative(val));
+}
+
+template <class T, TIfWord<T> = 0>
+TBigInt operator+(T lhs, const TBigInt &rhs) {
+    return rhs + lhs;
+}
+
+template <class T, TIfWord<T> = 0>
+TBigInt operator-(T lhs, const TBigInt &rhs) {
+    return -rhs + lhs;
+}
+
+template <class T, TIfWord<T> = 0>
+TBigInt operator*(T lhs, const TBigInt &rhs) {
+    return rhs * lhs;
+}
@@ -0,0 +1,178 @@
+#include "binary.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Limbs are written and viewed as they are in memory.
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "the binary format assumes a little-endian host");
+
+constexpr char binaryMagic[] = { 'T', 'B', 'I', binaryVersion };
+constexpr uint32_t negativeFlag = 1;
+
+size_t binarySize(const TBigInt &obj) {
+    return binaryHeaderSize + TBigIntView(obj).limbs().size() * sizeof(uint32_t);
+}
+
+std::to_chars_result toBinary(char *first, char *last, const TBigInt &obj) {
+    TBigIntView view(obj);
+    if (static_cast<size_t>(last - first) < binarySize(obj)) {
+        return { last, std::errc::value_too_large };
+    }
+    uint32_t flags = view.negative() ? negativeFlag : 0;
+    uint64_t size = view.limbs().size();
+    std::memcpy(first, binaryMagic, sizeof(binaryMagic));
+    std::memcpy(first + 4, &flags, sizeof(flags));
+    std::memcpy(first + 8, &size, sizeof(size));
+    if (size) {
+        std::memcpy(first + binaryHeaderSize, view.limbs().begin(), size * sizeof(uint32_t));
+    }
+    return { first + binarySize(obj), std::errc() };
+}
+
+// Checks the 16 header bytes alone and returns the number of limbs they announce.
+static std::optional<uint64_t> checkHeader(const char *header, bool &negative) {
+    uint32_t flags;
+    uint64_t size;
+    if (std::memcmp(header, binaryMagic, sizeof(binaryMagic))) {
+        return std::nullopt;
+    }
+    std::memcpy(&flags, header + 4, sizeof(flags));
+    std::memcpy(&size, header + 8, sizeof(size));
+    if ((flags & ~negativeFlag) || (flags && !size) || size > (SIZE_MAX - binaryHeaderSize) / sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+    negative = flags;
+    return size;
+}
+
+// Checks the header and returns the number of limbs, or nothing for a malformed record.
+static std::optional<uint64_t> parseHeader(const char *first, const char *last, bool &negative) {
+    if (static_cast<size_t>(last - first) < binaryHeaderSize) {
+        return std::nullopt;
+    }
+    std::optional<uint64_t> size = checkHeader(first, negative);
+    if (!size || *size > static_cast<size_t>(last - first - binaryHeaderSize) / sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+    uint32_t top = 0;
+    if (*size) {
+        std::memcpy(&top, first + binaryHeaderSize + (*size - 1) * sizeof(uint32_t), sizeof(top));
+    }
+    if (*size && !top) {                                // views cannot strip leading zeros
+        return std::nullopt;
+    }
+    return size;
+}
+
+std::from_chars_result viewBinary(const char *first, const char *last, TBigIntView &res) {
+    bool negative = false;
+    std::optional<uint64_t> size = parseHeader(first, last, negative);
+    const char *limbs = first + binaryHeaderSize;
+    if (!size || reinterpret_cast<uintptr_t>(limbs) % alignof(uint32_t)) {
+        return { first, std::errc::invalid_argument };
+    }
+    res = TBigIntView(TVector::TVectorView(*size, reinterpret_cast<const uint32_t*>(limbs)), negative);
+    return { limbs + *size * sizeof(uint32_t), std::errc() };
+}
+
+std::from_chars_result fromBinary(const char *first, const char *last, TBigInt &obj) {
+    bool negative = false;
+    std::optional<uint64_t> size = parseHeader(first, last, negative);
+    if (!size) {
+        return { first, std::errc::invalid_argument };
+    }
+    TVector limbs;
+    limbs.resize_uninitialized(*size);
+    if (*size) {
+        std::memcpy(limbs.begin(), first + binaryHeaderSize, *size * sizeof(uint32_t));
+    }
+    obj.neg = negative;
+    obj.data = std::move(limbs);
+    return { first + binaryHeaderSize + *size * sizeof(uint32_t), std::errc() };
+}
+
+void writeBinary(std::ostream &out, const TBigInt &obj) {
+    std::string buffer(binarySize(obj), '\0');
+    toBinary(buffer.data(), buffer.data() + buffer.size(), obj);
+    out.write(buffer.data(), buffer.size());
+}
+
+bool readBinary(std::istream &in, TBigInt &obj) {
+    constexpr size_t firstChunk = 1 << 16;              // limbs
+    char header[binaryHeaderSize];
+    if (!in.read(header, binaryHeaderSize)) {
+        return false;
+    }
+    bool negative = false;
+    std::optional<uint64_t> size = checkHeader(header, negative);
+    if (!size) {
+        in.setstate(std::ios::failbit);
+        return false;
+    }
+    TVector limbs;
+    for (size_t done = 0; done < *size; ) {             // doubling with the data that arrives, not what the header claims
+        size_t next = std::min<uint64_t>(*size, std::max(2 * done, firstChunk));
+        limbs.resize_uninitialized(next);
+        if (!in.read(reinterpret_cast<char*>(limbs.begin() + done), (next - done) * sizeof(uint32_t))) {
+            return false;
+        }
+        done = next;
+    }
+    if (*size && !limbs.back()) {
+        in.setstate(std::ios::failbit);
+        return false;
+    }
+    obj.neg = negative;
+    obj.data = std::move(limbs);
+    return true;
+}
+
+TMappedFile::TMappedFile(const std::string &path) : ptr(nullptr), length(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "TMappedFile: open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info)) {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), "TMappedFile: stat " + path);
+    }
+    length = info.st_size;
+    if (length) {                                       // mmap rejects empty mappings
+        void *addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "TMappedFile: mmap " + path);
+        }
+        ptr = static_cast<const char*>(addr);
+    }
+    close(fd);                                          // the mapping keeps the file alive
+}
+
+TMappedFile::~TMappedFile() {
+    if (ptr) {
+        munmap(const_cast<char*>(ptr), length);
+    }
+}
+
+const char* TMappedFile::begin() const {
+    return ptr;
+}
+
+const char* TMappedFile::end() const {
+    return ptr + length;
+}
+
+size_t TMappedFile::size() const {
+    return length;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "bigint.h"
+
+#include <string>
+
+// Binary format, all fields little-endian:
+//   bytes 0-3   magic "TBI" followed by the format version
+//   bytes 4-7   flags, bit 0 is the sign
+//   bytes 8-15  number of limbs n, the top one nonzero
+//   then n 32-bit limbs, least significant first
+// Records are a multiple of four bytes long, so a file of consecutive records keeps every
+// limb array aligned and can be read in place.
+constexpr uint8_t binaryVersion = 1;
+constexpr size_t binaryHeaderSize = 16;
+
+size_t binarySize(const TBigInt&);
+
+// Same contract as to_chars/from_chars: value_too_large for a short output buffer,
+// invalid_argument for a truncated or malformed record.
+std::to_chars_result toBinary(char*, char*, const TBigInt&);
+std::from_chars_result fromBinary(const char*, const char*, TBigInt&);
+
+void writeBinary(std::ostream&, const TBigInt&);
+bool readBinary(std::istream&, TBigInt&);               // false and failbit on a bad record
+
+// Points the view at the record's limbs without copying. The limbs must be 4-byte aligned.
+std::from_chars_result viewBinary(const char*, const char*, TBigIntView&);
+
+// Whole file mapped read-only.
+class TMappedFile {
+private:
+    const char *ptr;
+    size_t length;
+public:
+    explicit TMappedFile(const std::string&);
+    TMappedFile(const TMappedFile&) = delete;
+    TMappedFile& operator=(const TMappedFile&) = delete;
+    ~TMappedFile();
+
+    const char* begin() const;
+    const char* end() const;
+    size_t size() const;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "bigint.h"
+
+#include <array>
+
+// Lazy sums of products. lazy(a) * b starts an expression, + and - with other expressions
+// or plain numbers extend it, and assigning it to a TBigInt evaluates every term into the
+// destination: the products through addProduct/subProduct, the plain terms in place.
+// Expressions keep pointers to their operands and must be consumed in the same statement.
+struct TTerm {
+    const TBigInt *lhs;
+    const TBigInt *rhs;                                 // nullptr for a plain term
+    bool negative;
+};
+
+template <size_t N>
+struct TExpression {
+    std::array<TTerm, N> terms;
+
+    bool references(const TBigInt &obj) const {
+        for (const TTerm &term : terms) {
+            if (term.lhs == &obj || term.rhs == &obj) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void evaluate(TBigInt &res) const {
+        if (references(res)) {
+            TBigInt tmp;
+            evaluate(tmp);
+            res = std::move(tmp);
+            return;
+        }
+        res.clear();
+        for (const TTerm &term : terms) {               // products first, the first one lands in res directly
+            if (term.rhs && term.negative) {
+                res.subProduct(*term.lhs, *term.rhs);
+            } else if (term.rhs) {
+                res.addProduct(*term.lhs, *term.rhs);
+            }
+        }
+        for (const TTerm &term : terms) {
+            if (!term.rhs && term.negative) {
+                res -= *term.lhs;
+            } else if (!term.rhs) {
+                res += *term.lhs;
+            }
+        }
+    }
+};
+
+class TLazy {
+private:
+    const TBigInt &value;
+public:
+    explicit TLazy(const TBigInt &obj) : value(obj) {}
+
+    TExpression<1> operator*(const TBigInt &obj) const {
+        return { { { { &value, &obj, false } } } };
+    }
+};
+
+inline TLazy lazy(const TBigInt &obj) {
+    return TLazy(obj);
+}
+
+template <size_t N, size_t M>
+TExpression<N + M> join(const TExpression<N> &lhs, const TExpression<M> &rhs, bool negate) {
+    TExpression<N + M> res;
+    for (size_t i = 0; i < N; ++i) {
+        res.terms[i] = lhs.terms[i];
+    }
+    for (size_t i = 0; i < M; ++i) {
+        res.terms[N + i] = { rhs.terms[i].lhs, rhs.terms[i].rhs, rhs.terms[i].negative != negate };
+    }
+    return res;
+}
+
+inline TExpression<1> term(const TBigInt &obj) {
+    return { { { { &obj, nullptr, false } } } };
+}
+
+template <size_t N>
+TExpression<N> operator-(const TExpression<N> &expr) {
+    return join(TExpression<0>(), expr, true);
+}
+
+template <size_t N, size_t M>
+TExpression<N + M> operator+(const TExpression<N> &lhs, const TExpression<M> &rhs) {
+    return join(lhs, rhs, false);
+}
+
+template <size_t N, size_t M>
+TExpression<N + M> operator-(const TExpression<N> &lhs, const TExpression<M> &rhs) {
+    return join(lhs, rhs, true);
+}
+
+template <size_t N>
+TExpression<N + 1> operator+(const TExpression<N> &lhs, const TBigInt &rhs) {
+    return join(lhs, term(rhs), false);
+}
+
+template <size_t N>
+TExpression<N + 1> operator-(const TExpression<N> &lhs, const TBigInt &rhs) {
+    return join(lhs, term(rhs), true);
+}
+
+template <size_t N>
+TExpression<N + 1> operator+(const TBigInt &lhs, const TExpression<N> &rhs) {
+    return join(term(lhs), rhs, false);
+}
+
+template <size_t N>
+TExpression<N + 1> operator-(const TBigInt &lhs, const TExpression<N> &rhs) {
+    return join(term(lhs), rhs, true);
+}
+
+template <size_t N>
+TBigInt::TBigInt(const TExpression<N> &expr) : neg(), data() {
+    expr.evaluate(*this);
+}
+
+template <size_t N>
+TBigInt& TBigInt::operator=(const TExpression<N> &expr) {
+    expr.evaluate(*this);
+    return *this;
+}
@@ -0,0 +1,265 @@
+#include "gcd.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+using int128_t = __int128;
+
+static size_t bitLength(TVector::TVectorView data) {
+    return data.empty() ? 0 : TBigInt::limbBits * data.size() - __builtin_clz(data.begin()[data.size() - 1]);
+}
+
+// Bits [shift, shift + 62) of the number, which must not have any above them.
+static int64_t leadingBits(TVector::TVectorView data, size_t shift) {
+    unsigned __int128 window = 0;
+    for (size_t i = shift / TBigInt::limbBits + 3; i-- > shift / TBigInt::limbBits; ) {
+        window = window << TBigInt::limbBits | (i < data.size() ? data.begin()[i] : 0);
+    }
+    return static_cast<int64_t>(window >> shift % TBigInt::limbBits);
+}
+
+TGcd::TMatrix::TMatrix() : a(1), b(), c(), d(1) {}
+
+// (x, y) = (a x + b y, c x + d y) in place, one pass over the limbs.
+void TGcd::combine(TBigInt &x, TBigInt &y, int64_t a, int64_t b, int64_t c, int64_t d) {
+    if (x.neg) {
+        a = -a;
+        c = -c;
+    }
+    if (y.neg) {
+        b = -b;
+        d = -d;
+    }
+    size_t size = std::max(x.data.size(), y.data.size()) + 3;  // two limbs per factor and one for the sum
+    x.data.resize(size);
+    y.data.resize(size);
+    uint32_t *xs = x.data.begin(), *ys = y.data.begin();
+    int128_t nx = 0, ny = 0;
+    for (size_t i = 0; i < size; ++i) {
+        nx += static_cast<int128_t>(a) * xs[i] + static_cast<int128_t>(b) * ys[i];
+        ny += static_cast<int128_t>(c) * xs[i] + static_cast<int128_t>(d) * ys[i];
+        xs[i] = static_cast<uint32_t>(nx);
+        ys[i] = static_cast<uint32_t>(ny);
+        nx >>= TBigInt::limbBits;
+        ny >>= TBigInt::limbBits;
+    }
+    x.neg = nx < 0;
+    y.neg = ny < 0;
+    for (TBigInt *obj : { &x, &y }) {
+        if (obj->neg) {                                 // two's complement of the magnitude
+            uint32_t carry = 1;
+            for (uint32_t &limb : obj->data) {
+                limb = ~limb + carry;
+                carry &= !limb;
+            }
+        }
+        obj->neg = TBigInt::removeLeadingZeros(obj->data) ? false : obj->neg;
+    }
+}
+
+TBigInt TGcd::top(const TBigInt &obj, size_t limbs) {
+    if (obj.data.size() <= limbs) {
+        return TBigInt();
+    }
+    return TBigInt(TVector::TVectorView(obj.data.size() - limbs, obj.data.begin() + limbs), false);
+}
+
+TBigInt TGcd::bottom(const TBigInt &obj, size_t limbs) {
+    return TBigInt(TVector::TVectorView(std::min(obj.data.size(), limbs), obj.data.begin()), false);
+}
+
+TGcd::TMatrix TGcd::compose(const TMatrix &lhs, const TMatrix &rhs) {
+    TMatrix res;
+    res.a = lhs.a * rhs.a;
+    res.a.addProduct(lhs.b, rhs.c);
+    res.b = lhs.a * rhs.b;
+    res.b.addProduct(lhs.b, rhs.d);
+    res.c = lhs.c * rhs.a;
+    res.c.addProduct(lhs.d, rhs.c);
+    res.d = lhs.c * rhs.b;
+    res.d.addProduct(lhs.d, rhs.d);
+    return res;
+}
+
+// Makes x >= y >= 0, adjusting the rows of the matrix along.
+void TGcd::normalize(TBigInt &x, TBigInt &y, TMatrix *m) {
+    if (x.neg) {
+        x.neg = false;
+        if (m) {
+            m->a = -m->a;
+            m->b = -m->b;
+        }
+    }
+    if (y.neg) {
+        y.neg = false;
+        if (m) {
+            m->c = -m->c;
+            m->d = -m->d;
+        }
+    }
+    if (x < y) {
+        std::swap(x, y);
+        if (m) {
+            std::swap(m->a, m->c);
+            std::swap(m->b, m->d);
+        }
+    }
+}
+
+// The matrix took the upper parts hx, hy of x, y above the given limb to their current
+// values, so only the lower parts still have to be multiplied.
+void TGcd::apply(TMatrix &m, TBigInt &x, TBigInt &y, const TBigInt &hx, const TBigInt &hy, size_t limbs) {
+    TBigInt lx = bottom(x, limbs), ly = bottom(y, limbs);
+    TBigInt nx = m.a * lx, ny = m.c * lx;
+    nx.addProduct(m.b, ly);
+    ny.addProduct(m.d, ly);
+    x = nx + hx.shiftLimbs(limbs);
+    y = ny + hy.shiftLimbs(limbs);
+    normalize(x, y, &m);
+}
+
+void TGcd::euclidStep(TBigInt &x, TBigInt &y, TMatrix *m) {
+    auto [quot, rem] = x.divmod(y);
+    x = std::move(y);
+    y = std::move(rem);
+    if (m) {
+        m->a.subProduct(quot, m->c);
+        m->b.subProduct(quot, m->d);
+        std::swap(m->a, m->c);
+        std::swap(m->b, m->d);
+    }
+}
+
+// Runs euclid on the leading 62 bits of x and y aligned alike for as long as the quotients
+// provably match those of the full numbers (Knuth's algorithm L), keeping the cofactors
+// below 2^31, and then applies the cofactors to the full numbers in one pass.
+bool TGcd::lehmerStep(TBigInt &x, TBigInt &y, TMatrix *m) {
+    constexpr int64_t limit = INT64_C(1) << 31;
+    size_t bits = bitLength(x.data), shift = bits > 62 ? bits - 62 : 0;
+    int64_t xh = leadingBits(x.data, shift), yh = leadingBits(y.data, shift);
+    int64_t a = 1, b = 0, c = 0, d = 1;
+    while (yh + c > 0 && yh + d > 0 && std::max(std::abs(c), std::abs(d)) < limit) {
+        int64_t quot = (xh + a) / (yh + c);
+        if (quot != (xh + b) / (yh + d) || quot >= limit) {
+            break;
+        }
+        std::tie(a, c) = std::make_pair(c, a - quot * c);
+        std::tie(b, d) = std::make_pair(d, b - quot * d);
+        std::tie(xh, yh) = std::make_pair(yh, xh - quot * yh);
+    }
+    if (!b) {
+        return false;
+    }
+    combine(x, y, a, b, c, d);
+    if (m) {
+        combine(m->a, m->c, a, b, c, d);
+        combine(m->b, m->d, a, b, c, d);
+    }
+    normalize(x, y, m);
+    return true;
+}
+
+// Reduces while y has more than the given number of limbs.
+void TGcd::lehmer(TBigInt &x, TBigInt &y, size_t limbs, TMatrix *m) {
+    while (y.data.size() > limbs) {
+        if (!m && !limbs && x.data.size() <= 2) {       // plain euclid in machine words
+            uint64_t u = x.data[0] | (x.data.size() > 1 ? static_cast<uint64_t>(x.data[1]) << TBigInt::limbBits : 0);
+            uint64_t v = y.data[0] | (y.data.size() > 1 ? static_cast<uint64_t>(y.data[1]) << TBigInt::limbBits : 0);
+            while (v) {
+                std::tie(u, v) = std::make_pair(v, u % v);
+            }
+            x.data = { static_cast<uint32_t>(u), static_cast<uint32_t>(u >> TBigInt::limbBits) };
+            TBigInt::removeLeadingZeros(x.data);
+            y.clear();
+        } else if (!lehmerStep(x, y, m)) {
+            euclidStep(x, y, m);
+        }
+    }
+}
+
+// Reduces x >= y >= 0 until y has about half the limbs of x, using only the upper halves
+// recursively, and returns the matrix taking the old pair to the new one.
+TGcd::TMatrix TGcd::halfGcd(TBigInt &x, TBigInt &y) {
+    TMatrix res;
+    size_t size = x.data.size(), limbs = size / 2 + 1;
+    if (y.data.size() <= limbs) {
+        return res;
+    } else if (size < halfGcdThreshold) {
+        lehmer(x, y, limbs, &res);
+        return res;
+    }
+    TBigInt hx = top(x, limbs), hy = top(y, limbs);     // the upper half reduced to a quarter
+    res = halfGcd(hx, hy);
+    apply(res, x, y, hx, hy, limbs);
+    if (y.data.size() <= limbs) {
+        return res;
+    }
+    euclidStep(x, y, &res);
+    if (y.data.size() <= limbs || x.data.size() >= size) {
+        return res;
+    }
+    size_t shift = 2 * limbs > x.data.size() ? 2 * limbs - x.data.size() : 0;
+    hx = top(x, shift);                                 // about 3/4 left: its upper part halved again
+    hy = top(y, shift);
+    TMatrix second = halfGcd(hx, hy);
+    apply(second, x, y, hx, hy, shift);
+    return compose(second, res);
+}
+
+void TGcd::reduce(TBigInt &x, TBigInt &y, TMatrix *m) {
+    normalize(x, y, m);
+    while (y.data.size() >= (m ? gcdextCrossover : gcdCrossover)) {
+        TMatrix step = halfGcd(x, y);
+        if (m) {
+            *m = compose(step, *m);
+        }
+        if (!y.data.empty()) {
+            euclidStep(x, y, m);
+        }
+    }
+    lehmer(x, y, 0, m);
+}
+
+TBigInt gcd(const TBigInt &lhs, const TBigInt &rhs) {
+    TBigInt x = lhs < 0 ? -lhs : lhs, y = rhs < 0 ? -rhs : rhs;
+    TGcd::reduce(x, y, nullptr);
+    return x;
+}
+
+TBigInt lcm(const TBigInt &lhs, const TBigInt &rhs) {
+    if (lhs == 0 || rhs == 0) {
+        return TBigInt();
+    }
+    TBigInt res = lhs / gcd(lhs, rhs) * rhs;
+    return res < 0 ? -res : res;
+}
+
+std::tuple<TBigInt, TBigInt, TBigInt> gcdext(const TBigInt &lhs, const TBigInt &rhs) {
+    TBigInt x = lhs < 0 ? -lhs : lhs, y = rhs < 0 ? -rhs : rhs;
+    TGcd::TMatrix m;
+    TGcd::reduce(x, y, &m);
+    TBigInt s = lhs < 0 ? -m.a : m.a, t = rhs < 0 ? -m.b : m.b;
+    if (rhs != 0) {                                     // the smallest nonnegative s, t to match
+        TBigInt period = (rhs < 0 ? -rhs : rhs) / x;
+        s = s % period;
+        if (s < 0) {
+            s += period;
+        }
+        TBigInt rest = x;
+        rest.subProduct(s, lhs);
+        t = rest / rhs;
+    }
+    return { x, s, t };
+}
+
+TBigInt invmod(const TBigInt &val, const TBigInt &mod) {
+    if (mod <= 0) {
+        throw std::domain_error("TBigInt: the modulus must be positive");
+    }
+    auto [g, s, t] = gcdext(val, mod);
+    if (g != 1) {
+        throw std::domain_error("TBigInt: not invertible");
+    }
+    return s;
+}
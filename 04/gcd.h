@@ -0,0 +1,46 @@
+#pragma once
+
+#include "bigint.h"
+
+#include <tuple>
+
+// Lehmer's algorithm on the leading 62 bits of the operands, with a recursive half-gcd
+// for very large ones. Results are nonnegative.
+TBigInt gcd(const TBigInt&, const TBigInt&);
+TBigInt lcm(const TBigInt&, const TBigInt&);
+
+// g, s, t with s * a + t * b = g = gcd(a, b). Unless b is zero, s is reduced into [0, |b| / g).
+std::tuple<TBigInt, TBigInt, TBigInt> gcdext(const TBigInt&, const TBigInt&);
+
+// x in [0, m) with a * x = 1 mod m. Throws domain_error for m <= 0 or gcd(a, m) != 1.
+TBigInt invmod(const TBigInt&, const TBigInt&);
+
+// Helpers of the functions above, they need the limbs of TBigInt.
+class TGcd {
+private:
+    constexpr static size_t halfGcdThreshold = 1000;    // limbs where the recursion bottoms out in lehmer steps
+    constexpr static size_t gcdCrossover = 32000;       // limbs where the half-gcd starts to pay off
+    constexpr static size_t gcdextCrossover = 10000;    // sooner with cofactors, lehmer pays for them every step
+
+    // (x, y) -> (a x + b y, c x + d y), always of determinant +-1.
+    struct TMatrix {
+        TBigInt a, b, c, d;
+
+        TMatrix();
+    };
+
+    static void combine(TBigInt&, TBigInt&, int64_t, int64_t, int64_t, int64_t);
+    static TBigInt top(const TBigInt&, size_t);
+    static TBigInt bottom(const TBigInt&, size_t);
+    static TMatrix compose(const TMatrix&, const TMatrix&);
+    static void normalize(TBigInt&, TBigInt&, TMatrix*);
+    static void apply(TMatrix&, TBigInt&, TBigInt&, const TBigInt&, const TBigInt&, size_t);
+    static void euclidStep(TBigInt&, TBigInt&, TMatrix*);
+    static bool lehmerStep(TBigInt&, TBigInt&, TMatrix*);
+    static void lehmer(TBigInt&, TBigInt&, size_t, TMatrix*);
+    static TMatrix halfGcd(TBigInt&, TBigInt&);
+    static void reduce(TBigInt&, TBigInt&, TMatrix*);
+
+    friend TBigInt gcd(const TBigInt&, const TBigInt&);
+    friend std::tuple<TBigInt, TBigInt, TBigInt> gcdext(const TBigInt&, const TBigInt&);
+};
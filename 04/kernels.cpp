@@ -0,0 +1,340 @@
+#include "kernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86
+#endif
+
+using TAddKernel = uint32_t (*)(uint32_t*, const uint32_t*, const uint32_t*, size_t, uint32_t);
+using TCompareKernel = int32_t (*)(const uint32_t*, const uint32_t*, size_t);
+using TWidenKernel = void (*)(uint64_t*, const uint32_t*, size_t);
+
+struct TKernels {
+    TSimdLevel level;
+    TAddKernel add;
+    TAddKernel sub;
+    TCompareKernel compare;
+    TWidenKernel widen;
+};
+
+static uint32_t addScalar(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs, size_t n, uint32_t carry) {
+    uint64_t sum = carry;
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<uint64_t>(lhs[i]) + rhs[i];
+        res[i] = static_cast<uint32_t>(sum);
+        sum >>= 32;
+    }
+    return static_cast<uint32_t>(sum);
+}
+
+static uint32_t subScalar(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs, size_t n, uint32_t borrow) {
+    uint64_t diff = 0;
+    for (size_t i = 0; i < n; ++i) {
+        diff = static_cast<uint64_t>(lhs[i]) - rhs[i] - borrow;
+        res[i] = static_cast<uint32_t>(diff);
+        borrow = static_cast<uint32_t>(diff >> 63);
+    }
+    return borrow;
+}
+
+static int32_t compareScalar(const uint32_t *lhs, const uint32_t *rhs, size_t n) {
+    while (n--) {
+        if (lhs[n] != rhs[n]) {
+            return lhs[n] < rhs[n] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static void widenScalar(uint64_t *res, const uint32_t *src, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        res[i] += src[i];
+    }
+}
+
+// The vector kernels add all lanes at once and then settle the carries with one scalar
+// addition over lane masks: lanes that overflowed generate a carry into the next lane,
+// lanes that came out all ones pass an incoming carry on. Shifting the generate mask up
+// by one and adding the propagate mask ripples every carry through its run of
+// propagating lanes, and xor with the propagate mask leaves the lanes that receive one.
+// Subtraction is the same with borrows: lanes that wrapped generate, zero lanes propagate.
+
+#ifdef KERNELS_X86
+__attribute__((target("avx2")))
+static uint32_t addAvx2(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs, size_t n, uint32_t carry) {
+    const __m256i flip = _mm256_set1_epi32(INT32_MIN), ones = _mm256_set1_epi32(-1);
+    const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        __m256i sum = _mm256_add_epi32(a, b);
+        __m256i wrapped = _mm256_cmpgt_epi32(_mm256_xor_si256(a, flip), _mm256_xor_si256(sum, flip));
+        uint32_t generate = _mm256_movemask_ps(_mm256_castsi256_ps(wrapped));
+        uint32_t propagate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(sum, ones)));
+        uint32_t chain = (generate << 1 | carry) + propagate;
+        __m256i incoming = _mm256_set1_epi32((chain ^ propagate) & 0xff);
+        carry = chain >> 8;
+        sum = _mm256_sub_epi32(sum, _mm256_cmpeq_epi32(_mm256_and_si256(incoming, lanes), lanes));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i), sum);
+    }
+    return addScalar(res + i, lhs + i, rhs + i, n - i, carry);
+}
+
+__attribute__((target("avx2")))
+static uint32_t subAvx2(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs, size_t n, uint32_t borrow) {
+    const __m256i flip = _mm256_set1_epi32(INT32_MIN), zero = _mm256_setzero_si256();
+    const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        __m256i diff = _mm256_sub_epi32(a, b);
+        __m256i wrapped = _mm256_cmpgt_epi32(_mm256_xor_si256(b, flip), _mm256_xor_si256(a, flip));
+        uint32_t generate = _mm256_movemask_ps(_mm256_castsi256_ps(wrapped));
+        uint32_t propagate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(diff, zero)));
+        uint32_t chain = (generate << 1 | borrow) + propagate;
+        __m256i incoming = _mm256_set1_epi32((chain ^ propagate) & 0xff);
+        borrow = chain >> 8;
+        diff = _mm256_add_epi32(diff, _mm256_cmpeq_epi32(_mm256_and_si256(incoming, lanes), lanes));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i), diff);
+    }
+    return subScalar(res + i, lhs + i, rhs + i, n - i, borrow);
+}
+
+__attribute__((target("avx2")))
+static int32_t compareAvx2(const uint32_t *lhs, const uint32_t *rhs, size_t n) {
+    for (; n >= 8; n -= 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + n - 8));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + n - 8));
+        uint32_t equal = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+        if (equal != 0xff) {
+            size_t idx = n - 8 + 31 - __builtin_clz(~equal & 0xff);
+            return lhs[idx] < rhs[idx] ? -1 : 1;
+        }
+    }
+    return compareScalar(lhs, rhs, n);
+}
+
+__attribute__((target("avx2")))
+static void widenAvx2(uint64_t *res, const uint32_t *src, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i wide = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(res + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i), _mm256_add_epi64(acc, wide));
+    }
+    widenScalar(res + i, src + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static uint32_t addSse2(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs, size_t n, uint32_t carry) {
+    const __m128i flip = _mm_set1_epi32(INT32_MIN), ones = _mm_set1_epi32(-1);
+    const __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        __m128i sum = _mm_add_epi32(a, b);
+        __m128i wrapped = _mm_cmpgt_epi32(_mm_xor_si128(a, flip), _mm_xor_si128(sum, flip));
+        uint32_t generate = _mm_movemask_ps(_mm_castsi128_ps(wrapped));
+        uint32_t propagate = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(sum, ones)));
+        uint32_t chain = (generate << 1 | carry) + propagate;
+        __m128i incoming = _mm_set1_epi32((chain ^ propagate) & 0xf);
+        carry = chain >> 4;
+        sum = _mm_sub_epi32(sum, _mm_cmpeq_epi32(_mm_and_si128(incoming, lanes), lanes));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(res + i), sum);
+    }
+    return addScalar(res + i, lhs + i, rhs + i, n - i, carry);
+}
+
+__attribute__((target("sse2")))
+static uint32_t subSse2(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs, size_t n, uint32_t borrow) {
+    const __m128i flip = _mm_set1_epi32(INT32_MIN), zero = _mm_setzero_si128();
+    const __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        __m128i diff = _mm_sub_epi32(a, b);
+        __m128i wrapped = _mm_cmpgt_epi32(_mm_xor_si128(b, flip), _mm_xor_si128(a, flip));
+        uint32_t generate = _mm_movemask_ps(_mm_castsi128_ps(wrapped));
+        uint32_t propagate = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(diff, zero)));
+        uint32_t chain = (generate << 1 | borrow) + propagate;
+        __m128i incoming = _mm_set1_epi32((chain ^ propagate) & 0xf);
+        borrow = chain >> 4;
+        diff = _mm_add_epi32(diff, _mm_cmpeq_epi32(_mm_and_si128(incoming, lanes), lanes));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(res + i), diff);
+    }
+    return subScalar(res + i, lhs + i, rhs + i, n - i, borrow);
+}
+
+__attribute__((target("sse2")))
+static int32_t compareSse2(const uint32_t *lhs, const uint32_t *rhs, size_t n) {
+    for (; n >= 4; n -= 4) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + n - 4));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + n - 4));
+        uint32_t equal = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+        if (equal != 0xf) {
+            size_t idx = n - 4 + 31 - __builtin_clz(~equal & 0xf);
+            return lhs[idx] < rhs[idx] ? -1 : 1;
+        }
+    }
+    return compareScalar(lhs, rhs, n);
+}
+
+__attribute__((target("sse2")))
+static void widenSse2(uint64_t *res, const uint32_t *src, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i limbs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(res + i));
+        __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(res + i + 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(res + i), _mm_add_epi64(low, _mm_unpacklo_epi32(limbs, zero)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(res + i + 2), _mm_add_epi64(high, _mm_unpackhi_epi32(limbs, zero)));
+    }
+    widenScalar(res + i, src + i, n - i);
+}
+#endif
+
+static TSimdLevel bestLevel() {
+#ifdef KERNELS_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return TSimdLevel::Avx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        return TSimdLevel::Sse2;
+    }
+#endif
+    return TSimdLevel::Scalar;
+}
+
+static TKernels kernelsFor(TSimdLevel level) {
+    switch (level) {
+#ifdef KERNELS_X86
+    case TSimdLevel::Avx2:
+        return { level, addAvx2, subAvx2, compareAvx2, widenAvx2 };
+    case TSimdLevel::Sse2:
+        return { level, addSse2, subSse2, compareSse2, widenSse2 };
+#endif
+    default:
+        return { TSimdLevel::Scalar, addScalar, subScalar, compareScalar, widenScalar };
+    }
+}
+
+static TKernels& kernels() {
+    static TKernels current = kernelsFor(bestLevel());
+    return current;
+}
+
+// Anything shorter than the widest register skips the dispatch altogether.
+constexpr size_t shortLimbs = 8;
+
+uint32_t addN(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs, size_t n) {
+    return n < shortLimbs ? addScalar(res, lhs, rhs, n, 0) : kernels().add(res, lhs, rhs, n, 0);
+}
+
+uint32_t subN(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs, size_t n) {
+    return n < shortLimbs ? subScalar(res, lhs, rhs, n, 0) : kernels().sub(res, lhs, rhs, n, 0);
+}
+
+int32_t compareN(const uint32_t *lhs, const uint32_t *rhs, size_t n) {
+    return n < shortLimbs ? compareScalar(lhs, rhs, n) : kernels().compare(lhs, rhs, n);
+}
+
+void addWideN(uint64_t *res, const uint32_t *src, size_t n) {
+    n < shortLimbs ? widenScalar(res, src, n) : kernels().widen(res, src, n);
+}
+
+uint32_t add1(uint32_t *res, const uint32_t *src, size_t n, uint32_t carry) {
+    size_t i = 0;
+    for (; carry && i < n; ++i) {
+        res[i] = src[i] + carry;
+        carry = res[i] < carry;
+    }
+    if (res != src) {
+        std::copy(src + i, src + n, res + i);
+    }
+    return carry;
+}
+
+uint32_t sub1(uint32_t *res, const uint32_t *src, size_t n, uint32_t borrow) {
+    size_t i = 0;
+    for (; borrow && i < n; ++i) {
+        uint32_t limb = src[i];
+        res[i] = limb - borrow;
+        borrow = limb < borrow;
+    }
+    if (res != src) {
+        std::copy(src + i, src + n, res + i);
+    }
+    return borrow;
+}
+
+uint32_t mul1(uint32_t *res, const uint32_t *src, size_t n, uint32_t mul) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        carry += static_cast<uint64_t>(src[i]) * mul;
+        res[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t addMul1(uint32_t *res, const uint32_t *src, size_t n, uint32_t mul) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        carry += static_cast<uint64_t>(src[i]) * mul + res[i];     // at most 2^64 - 1
+        res[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t subMul1(uint32_t *res, const uint32_t *src, size_t n, uint32_t mul) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        borrow += static_cast<uint64_t>(src[i]) * mul;
+        uint32_t limb = res[i], low = static_cast<uint32_t>(borrow);
+        res[i] = limb - low;
+        borrow = (borrow >> 32) + (limb < low);
+    }
+    return static_cast<uint32_t>(borrow);
+}
+
+uint32_t shiftLeftN(uint32_t *res, const uint32_t *src, size_t n, uint32_t bits) {
+    if (!bits || !n) {
+        std::copy_backward(src, src + n, res + n);
+        return 0;
+    }
+    uint32_t out = src[n - 1] >> (32 - bits);
+    for (size_t i = n - 1; i; --i) {                    // downwards, so res may sit above src
+        res[i] = src[i] << bits | src[i - 1] >> (32 - bits);
+    }
+    res[0] = src[0] << bits;
+    return out;
+}
+
+uint32_t shiftRightN(uint32_t *res, const uint32_t *src, size_t n, uint32_t bits) {
+    if (!bits || !n) {
+        std::copy(src, src + n, res);
+        return 0;
+    }
+    uint32_t out = src[0] << (32 - bits);
+    for (size_t i = 0; i + 1 < n; ++i) {                // upwards, so res may sit below src
+        res[i] = src[i] >> bits | src[i + 1] << (32 - bits);
+    }
+    res[n - 1] = src[n - 1] >> bits;
+    return out;
+}
+
+TSimdLevel simdLevel() {
+    return kernels().level;
+}
+
+TSimdLevel setSimdLevel(TSimdLevel level) {
+    kernels() = kernelsFor(static_cast<int32_t>(level) < static_cast<int32_t>(bestLevel()) ? level : bestLevel());
+    return kernels().level;
+}
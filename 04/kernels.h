@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Limb kernels over n limbs, least significant first. res may alias lhs or rhs.
+// The widest implementation the cpu supports is picked on first use.
+uint32_t addN(uint32_t*, const uint32_t*, const uint32_t*, size_t);        // returns the carry
+uint32_t subN(uint32_t*, const uint32_t*, const uint32_t*, size_t);        // returns the borrow
+int32_t compareN(const uint32_t*, const uint32_t*, size_t);                 // sign of lhs - rhs
+void addWideN(uint64_t*, const uint32_t*, size_t);                          // 64-bit slots += limbs, no carries
+
+// Single limb operands and shifts, scalar: each is one carry chain through the limbs.
+// res may equal src, or overlap it in the direction of the shift. Whole limbs of a shift
+// are pointer offsets.
+uint32_t add1(uint32_t*, const uint32_t*, size_t, uint32_t);               // src + limb, returns the carry
+uint32_t sub1(uint32_t*, const uint32_t*, size_t, uint32_t);               // src - limb, returns the borrow
+uint32_t mul1(uint32_t*, const uint32_t*, size_t, uint32_t);               // src * limb, returns the top limb
+uint32_t addMul1(uint32_t*, const uint32_t*, size_t, uint32_t);            // res += src * limb, returns the top limb
+uint32_t subMul1(uint32_t*, const uint32_t*, size_t, uint32_t);            // res -= src * limb, returns the borrow limb
+uint32_t shiftLeftN(uint32_t*, const uint32_t*, size_t, uint32_t);         // by 0-31 bits, returns the bits out
+uint32_t shiftRightN(uint32_t*, const uint32_t*, size_t, uint32_t);        // same, the bits out on top
+
+enum class TSimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+TSimdLevel simdLevel();
+TSimdLevel setSimdLevel(TSimdLevel);    // capped by the cpu, returns the level in use; not thread safe
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "bigint.h"
+
+#include <array>
+
+// Integer literals of any length: 1234567890123456789012345678901234567890_big. The digits
+// are converted to limbs during compilation into static storage and the literal is a view
+// of it, so there is no parsing or allocation at run time. Decimal, 0x, 0b and octal forms
+// and ' separators are accepted; -x_big negates the view, TBigInt n(x_big) copies it, and
+// the arithmetic and comparison operators take it as it is.
+template <size_t N>
+constexpr size_t literalPrefix(const std::array<char, N> &text) {
+    if (N > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X' || text[1] == 'b' || text[1] == 'B')) {
+        return 2;
+    }
+    return N > 1 && text[0] == '0' ? 1 : 0;
+}
+
+template <size_t N>
+constexpr uint32_t literalRadix(const std::array<char, N> &text) {
+    if (literalPrefix(text) == 2) {
+        return text[1] == 'x' || text[1] == 'X' ? 16 : 2;
+    }
+    return literalPrefix(text) ? 8 : 10;
+}
+
+constexpr uint32_t literalDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return UINT32_MAX;
+}
+
+template <size_t N>
+constexpr bool literalValid(const std::array<char, N> &text) {
+    for (size_t i = literalPrefix(text); i < N; ++i) {
+        if (text[i] != '\'' && literalDigit(text[i]) >= literalRadix(text)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t L, size_t N>
+constexpr std::array<uint32_t, L> literalLimbs(const std::array<char, N> &text) {
+    std::array<uint32_t, L> res{};
+    for (size_t i = literalPrefix(text); i < N; ++i) {
+        if (text[i] == '\'') {
+            continue;
+        }
+        uint64_t carry = literalDigit(text[i]);
+        for (uint32_t &limb : res) {
+            carry += static_cast<uint64_t>(limb) * literalRadix(text);
+            limb = static_cast<uint32_t>(carry);
+            carry >>= TBigInt::limbBits;
+        }
+    }
+    return res;
+}
+
+template <size_t N>
+constexpr size_t literalLength(const std::array<uint32_t, N> &limbs) {
+    size_t res = N;
+    while (res && !limbs[res - 1]) {
+        --res;
+    }
+    return res;
+}
+
+template <size_t L, size_t N>
+constexpr std::array<uint32_t, L> literalTrim(const std::array<uint32_t, N> &limbs) {
+    std::array<uint32_t, L> res{};
+    for (size_t i = 0; i < L; ++i) {
+        res[i] = limbs[i];
+    }
+    return res;
+}
+
+template <char... Chars>
+struct TBigIntLiteral {
+    constexpr static std::array<char, sizeof...(Chars)> text = { Chars... };
+    static_assert(literalValid(text), "TBigInt literals must be integers");
+
+    constexpr static size_t bound = (4 * text.size() + TBigInt::limbBits - 1) / TBigInt::limbBits;    // 4 bits cover any digit
+    constexpr static std::array<uint32_t, bound> parsed = literalLimbs<bound>(text);
+    constexpr static std::array<uint32_t, literalLength(parsed)> limbs = literalTrim<literalLength(parsed)>(parsed);
+};
+
+template <char... Chars>
+TBigIntView operator""_big() {
+    using TLiteral = TBigIntLiteral<Chars...>;
+    return TBigIntView(TVector::TVectorView(TLiteral::limbs.size(), TLiteral::limbs.data()), false);
+}
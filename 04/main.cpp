@@ -1,12 +1,33 @@
 #include "vector.h"
 #include "bigint.h"
+#include "montgomery.h"
+#include "accumulator.h"
+#include "binary.h"
+#include "expression.h"
+#include "literal.h"
+#include "gcd.h"
+#include "roots.h"
+#include "kernels.h"
+#include "ntt.h"
+#include "threadpool.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
 #include <random>
 #include <sstream>
+#include <fstream>
 #include <tuple>
 #include <array>
+#include <stdexcept>
 #include <vector>
 #include <cassert>
+#include <csignal>
+#include <system_error>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 void TestVector() {
     {
@@ -43,9 +64,9 @@ void TestVector() {
         assert(myVec.empty());
 
         std::vector<uint32_t> stlVec;
-        assert(myVec.capacity() == stlVec.capacity());
+        assert(myVec.capacity() == TVector::inlineCapacity);
         assert(myVec.size() == stlVec.size());
-        assert(myVec.begin() == stlVec.data());
+        assert(myVec.begin() == myVec.end());
     }
     {
         TVector myVec1 = { 1, 2, 3, 4, 5 };
@@ -53,67 +74,77 @@ void TestVector() {
         assert(!std::equal(myVec1.begin(), myVec1.end(), myVec2.begin()));
 
         TVector myVec3 = std::move(myVec1);
-        assert(!myVec1.size() && !myVec1.capacity());
+        assert(!myVec1.size() && myVec1.capacity() == TVector::inlineCapacity);
         std::vector<uint32_t> tmp = { 1, 2, 3, 4, 5 };
         assert(myVec3.size() == tmp.size());
         assert(std::equal(myVec3.rbegin(), myVec3.rend(), tmp.rbegin()));
 
         myVec1 = std::move(myVec2);
-        assert(!myVec2.size() && !myVec2.capacity());
+        assert(!myVec2.size() && myVec2.capacity() == TVector::inlineCapacity);
         tmp = { 6, 7, 8, 9, 0 };
         assert(myVec1.size() == tmp.size());
         assert(std::equal(myVec1.begin(), myVec1.end(), tmp.begin()));
     }
-    std::cerr << "TestVector is OK" << std::endl;
-}
+    {                                       // inline storage
+        TVector small = { 1, 2, 3, 4 };
+        const uint32_t *storage = small.begin();
+        small.pop_back();
+        small.push_back(5);
+        assert(small.capacity() == TVector::inlineCapacity && small.begin() == storage);
 
-std::string runCommand(const std::string &command) {
-    std::ostringstream request;
-    request << "echo '" << command << "' | ./script.py";
-    FILE *ifs = popen(request.str().c_str(), "r");
-    char buffer[512];
-    if (fscanf(ifs, "%s", buffer) == 1) {
-        fclose(ifs);
-        return buffer;
-    }
-    fclose(ifs);
-    return "";
-}
+        TVector moved = std::move(small);
+        assert(moved.begin() != storage && moved.back() == 5 && small.begin() == storage);
 
-void checkOperation(const std::vector<std::pair<std::string, std::string>> &operands, char op) {
-    for (const auto &[lhs, rhs] : operands) {
-        std::pair<TBigInt, TBigInt> numbers = std::make_pair(TBigInt(lhs), TBigInt(rhs));
-        TBigInt product;
-        switch (op) {
-        case '+':
-            product = numbers.first + numbers.second;
-            break;
-        case '-':
-            product = numbers.first - numbers.second;
-            break;
-        case '*':
-            product = numbers.first * numbers.second;
-            break;
-        default:
-            break;
+        small.push_back(7);
+        TVector large = { 1, 2, 3, 4, 5, 6 };
+        const uint32_t *heap = large.begin();
+        large = std::move(small);
+        assert(large.size() == 1 && large[0] == 7 && large.begin() == heap);
+        small = TVector({ 1, 2, 3, 4, 5, 6 });
+        assert(small.capacity() == 6 && small.back() == 6);
+
+        TVector copy = moved;
+        moved.push_back(6);
+        assert(copy.size() == 4 && moved.capacity() == 2 * TVector::inlineCapacity);
+        assert(std::equal(copy.begin(), copy.end(), moved.begin()));
+    }
+    {                                       // uninitialized growth
+        TVector vec = { 1, 2, 3 };
+        vec.resize_uninitialized(1000);
+        assert(vec.size() == 1000 && vec.capacity() == 1000 && vec[0] == 1 && vec[2] == 3);
+        std::fill(vec.begin(), vec.end(), 9);
+        vec.resize_uninitialized(2);
+        vec.resize(5000);
+        assert(vec.size() == 5000 && vec[1] == 9 && vec[2] == 0 && vec.back() == 0);
+    }
+    {                                       // self assignment
+        for (TVector vec : { TVector({ 1, 2, 3 }), TVector({ 1, 2, 3, 4, 5, 6, 7, 8, 9 }) }) {
+            TVector &alias = vec;
+            size_t size = vec.size();
+            vec = alias;
+            assert(vec.size() == size && vec[2] == 3 && vec.back() == size);
+            vec = std::move(alias);
+            assert(vec.size() == size && vec[2] == 3 && vec.back() == size);
         }
-        std::ostringstream os;
-        os << product;
-        assert(os.str() == runCommand(lhs + " " + op + " " + rhs));
     }
+    std::cerr << "TestVector is OK" << std::endl;
 }
 
-std::string generateRandomNumber(size_t length) {
-    static std::mt19937 rand_gen(time(0));
+std::string generateRandomNumber(size_t length, std::mt19937 &gen) {
     std::string res;
     res.reserve(length + 1);
-    res.push_back(rand_gen() & 1 ? '+' : '-');
+    res.push_back(gen() & 1 ? '+' : '-');
     for (size_t i = 0; i < length; ++i) {
-        res.push_back('0' + (rand_gen() % 10));
+        res.push_back('0' + (gen() % 10));
     }
     return res;
 }
 
+std::string generateRandomNumber(size_t length) {
+    static std::mt19937 rand_gen(time(0));
+    return generateRandomNumber(length, rand_gen);
+}
+
 std::string_view removePlusPrefix(std::string_view str) {
     if (str.size() && str.front() == '+') {
         str.remove_prefix(1);
@@ -122,18 +153,6 @@ std::string_view removePlusPrefix(std::string_view str) {
 }
 
 void TestBigInt() {
-    // {                                       // comparing output with python script
-    //     constexpr size_t operandsQuantity = 16;
-    //     constexpr size_t randomNumberLength = 128;
-    //     std::vector<std::pair<std::string, std::string>> terms(operandsQuantity);
-    //     for (auto &[lhs, rhs] : terms) {
-    //         lhs = generateRandomNumber(randomNumberLength);
-    //         rhs = generateRandomNumber(randomNumberLength);
-    //     }
-    //     checkOperation(terms, '+');
-    //     checkOperation(terms, '-');
-    //     checkOperation(terms, '*');
-    // }
     {                                       // io operators
         std::array<std::istringstream, 4> inputs = {
             std::istringstream("3901381239408349345771209432747289178329484533713"),
@@ -149,6 +168,62 @@ void TestBigInt() {
             assert(removePlusPrefix(input.str()) == output.str());
         }
     }
+    {                                       // to_chars and from_chars
+        std::string text = "-1" + std::string(200, '0') + "7";
+        TBigInt n;
+        auto [ptr, ec] = from_chars(text.data(), text.data() + text.size(), n);
+        assert(ec == std::errc() && ptr == text.data() + text.size());
+        std::array<char, 256> buffer;
+        auto [end, err] = to_chars(buffer.begin(), buffer.end(), n);
+        assert(err == std::errc() && std::string(buffer.begin(), end) == text);
+        assert(to_chars(buffer.begin(), buffer.begin() + 202, n).ec == std::errc::value_too_large);
+        assert(to_chars(buffer.begin(), buffer.begin(), TBigInt()).ec == std::errc::value_too_large);
+        assert(to_chars(buffer.begin(), buffer.begin() + 1, TBigInt()).ptr == buffer.begin() + 1 && buffer[0] == '0');
+
+        std::string_view partial = "-000123abc";
+        auto [rest, code] = from_chars(partial.begin(), partial.end(), n);
+        assert(code == std::errc() && rest == partial.begin() + 7 && n == -123);
+        for (std::string_view bad : { "", "-", "+x", "abc" }) {
+            assert(from_chars(bad.begin(), bad.end(), n).ec == std::errc::invalid_argument);
+            assert(n == -123);
+        }
+        size_t thrown = 0;
+        for (std::string_view bad : { "", " ", "--5", "+-5", "12a", "1 2", "0x10" }) {
+            try {
+                TBigInt parsed(bad);
+            } catch (const std::invalid_argument&) {
+                ++thrown;
+            }
+        }
+        assert(thrown == 7 && TBigInt(" -0012 ") == -12 && TBigInt("+7") == 7);
+
+        std::istringstream input("  42 -+7 -x ");
+        input >> n;
+        assert(n == 42 && input.get() == ' ');
+        input >> n;
+        assert(input.fail() && (input.clear(), input.get() == '-') && input.get() == '+');
+        input >> n;
+        assert(n == 7 && input.get() == ' ');
+        input >> n;
+        assert(input.fail() && (input.clear(), input.get() == '-') && input.get() == 'x');
+        input >> n;
+        assert(input.fail() && input.eof());
+    }
+    {                                       // divide-and-conquer decimal conversion
+        std::mt19937 gen(7);
+        for (size_t length : { 143, 144, 145, 288, 289, 5000, 70000 }) {
+            std::string text(1, '1' + gen() % 9);
+            for (size_t i = 1; i < length; ++i) {
+                text.push_back('0' + gen() % 10);
+            }
+            std::ostringstream os;
+            os << TBigInt(text) << ' ' << TBigInt("-000" + text);
+            assert(os.str() == text + " -" + text);
+            std::string power = "1" + std::string(length, '0');
+            assert(TBigInt(power) == TBigInt(power.substr(0, length)) * 10);
+            assert(TBigInt(power) - 1 == TBigInt(std::string(length, '9')));
+        }
+    }
     {                                       // unary minus
         std::vector<std::string> numbers = {
             "-34573947923842911239897459",
@@ -231,6 +306,571 @@ void TestBigInt() {
             assert(os.str() == result);
         }
     }
+    {                                       // limb boundaries
+        TBigInt word("4294967296");
+        std::ostringstream os;
+        os << word * word << ' ' << word * word - 1 << ' ' << word - 1;
+        assert(os.str() == "18446744073709551616 18446744073709551615 4294967295");
+    }
+    {                                       // schoolbook, karatsuba and ntt tiers
+        TBigInt::TThresholds tuned = TBigInt::getThresholds();
+        TBigInt::setThresholds({ 20, 1000, 1000, 1000 });    // the toom tiers are shadowed by ntt
+        for (auto [nines, tier] : { std::make_pair(100, TBigInt::TMultiplyTier::Schoolbook), std::make_pair(5000, TBigInt::TMultiplyTier::Karatsuba), std::make_pair(12000, TBigInt::TMultiplyTier::Ntt) }) {
+            TBigInt n(std::string(nines, '9'));
+            assert(TBigInt::multiplyTier(TBigIntView(n).limbs().size(), TBigIntView(n).limbs().size()) == tier);
+            std::ostringstream os;
+            os << n * n;
+            assert(os.str() == std::string(nines - 1, '9') + "8" + std::string(nines - 1, '0') + "1");
+        }
+        TBigInt::setThresholds(tuned);
+    }
+    {                                       // unbalanced karatsuba and ntt
+        TBigInt::TThresholds tuned = TBigInt::getThresholds();
+        TBigInt::setThresholds({ 20, 1000, 1000, 1000 });
+        for (auto [lhsNines, rhsNines, tier] : { std::make_tuple(20000, 1500, TBigInt::TMultiplyTier::Karatsuba), std::make_tuple(40000, 12000, TBigInt::TMultiplyTier::Ntt) }) {
+            TBigInt lhs(std::string(lhsNines, '9')), rhs(std::string(rhsNines, '9'));
+            assert(TBigInt::multiplyTier(TBigIntView(lhs).limbs().size(), TBigIntView(rhs).limbs().size()) == tier);
+            assert(lhs * rhs + lhs + rhs + 1 == TBigInt("1" + std::string(lhsNines + rhsNines, '0')));
+        }
+        TBigInt::setThresholds(tuned);
+    }
+    {                                       // unbalanced karatsuba over toom chunks
+        TBigInt::TThresholds tuned = TBigInt::getThresholds();
+        TBigInt lhs(std::string(30000, '9')), rhs(std::string(3000, '9'));
+        size_t lhsSize = TBigIntView(lhs).limbs().size(), rhsSize = TBigIntView(rhs).limbs().size();
+        for (auto [thresholds, tier] : { std::make_pair(TBigInt::TThresholds{ 4, 40, SIZE_MAX, SIZE_MAX }, TBigInt::TMultiplyTier::ToomCook3), std::make_pair(TBigInt::TThresholds{ 4, 40, 80, SIZE_MAX }, TBigInt::TMultiplyTier::ToomCook4) }) {
+            TBigInt::setThresholds(thresholds);
+            assert(TBigInt::multiplyTier(lhsSize, rhsSize) == TBigInt::TMultiplyTier::Karatsuba && TBigInt::multiplyTier(rhsSize, rhsSize) == tier);
+            assert(lhs * rhs + lhs + rhs + 1 == TBigInt("1" + std::string(33000, '0')));
+        }
+        TBigInt::setThresholds(tuned);
+    }
+    {                                       // squaring kernels
+        for (size_t nines : { 100, 5000, 12000 }) {
+            TBigInt n("-" + std::string(nines, '9')), copy(n);
+            assert(n.square() == n * copy);
+            assert(n * n == n * copy);
+            assert(n.square() - n * 2 + 1 == TBigInt("1" + std::string(2 * nines, '0')));
+        }
+    }
+    {                                       // parallel karatsuba
+        std::vector<std::pair<TBigInt, TBigInt>> operands;
+        for (auto [lhs, rhs] : std::vector<std::pair<size_t, size_t>>{ { 7000, 7000 }, { 50000, 3000 }, { 9000, 8000 } }) {
+            operands.emplace_back(TBigInt(generateRandomNumber(lhs)), TBigInt(generateRandomNumber(rhs)));
+        }
+        std::vector<TBigInt> serial;
+        for (const auto &[lhs, rhs] : operands) {
+            serial.push_back(lhs * rhs);
+            serial.push_back(lhs.square());
+        }
+        TBigInt::setThreads(4, 32);
+        for (size_t i = 0; i < operands.size(); ++i) {
+            assert(operands[i].first * operands[i].second == serial[2 * i]);
+            assert(operands[i].first.square() == serial[2 * i + 1]);
+        }
+        TBigInt::setThreads(1);
+    }
+    {                                       // thread pool
+        TThreadPool pool(2);
+        std::function<size_t(size_t)> leaves = [&](size_t depth) -> size_t {
+            if (!depth) {
+                return 1;
+            }
+            size_t left = 0;
+            TThreadPool::TTask task([&] { left = leaves(depth - 1); });
+            pool.submit(task);
+            size_t right = leaves(depth - 1);
+            pool.wait(task);
+            return left + right;
+        };
+        assert(leaves(12) == 4096);
+
+        std::atomic<size_t> ran(0);
+        TThreadPool::TTask failing([&] { ++ran; throw std::runtime_error("task"); });
+        pool.submit(failing);
+        bool thrown = false;
+        try {
+            pool.wait(failing);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && ran == 1);
+        try {
+            TThreadPool::TTask slow([&] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); ++ran; });
+            pool.submit(slow);
+            throw std::logic_error("caller");
+        } catch (const std::logic_error&) {
+            assert(ran == 2);                       // unwinding waited for the submitted task
+        }
+    }
+    {                                       // thresholds
+        TBigInt::TThresholds tuned = TBigInt::getThresholds(), low = { 4, 6, 12, 20 }, high = low;
+        high.karatsuba = high.toom3 = high.toom4 = high.ntt = SIZE_MAX;
+        std::vector<std::pair<TBigInt, TBigInt>> operands;
+        for (auto [lhs, rhs] : std::vector<std::pair<size_t, size_t>>{ { 40, 40 }, { 300, 290 }, { 900, 700 }, { 2000, 500 }, { 3000, 3000 } }) {
+            operands.emplace_back(TBigInt(generateRandomNumber(lhs)), TBigInt(generateRandomNumber(rhs)));
+        }
+        TBigInt::setThresholds(high);                   // schoolbook only
+        std::vector<TBigInt> expected;
+        for (const auto &[lhs, rhs] : operands) {
+            expected.push_back(lhs * rhs);
+        }
+        TBigInt::setThresholds(low);
+        for (size_t i = 0; i < operands.size(); ++i) {
+            assert(operands[i].first * operands[i].second == expected[i]);
+            assert(operands[i].second * operands[i].first == expected[i]);
+        }
+        TBigInt::setThresholds(tuned);
+        for (TBigInt::TThresholds bad : { TBigInt::TThresholds{ 3, 768, 2048, 1024 }, TBigInt::TThresholds{ 24, 2, 2048, 1024 } }) {
+            bool thrown = false;
+            try {
+                TBigInt::setThresholds(bad);
+            } catch (const std::invalid_argument&) {
+                thrown = true;
+            }
+            assert(thrown);
+        }
+        assert(TBigInt::getThresholds().karatsuba == tuned.karatsuba);
+    }
+    {                                       // toom-cook tiers
+        TBigInt::TThresholds tuned = TBigInt::getThresholds();
+        std::vector<std::pair<TBigInt, TBigInt>> operands;
+        for (auto [lhs, rhs] : std::vector<std::pair<size_t, size_t>>{ { 400, 400 }, { 1000, 900 }, { 5000, 4000 }, { 9000, 6800 }, { 12000, 7000 } }) {
+            operands.emplace_back(TBigInt(generateRandomNumber(lhs)), TBigInt(generateRandomNumber(rhs)));
+        }
+        TBigInt::setThresholds({ SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX });   // schoolbook only
+        std::vector<TBigInt> expected;
+        for (const auto &[lhs, rhs] : operands) {
+            expected.push_back(lhs * rhs);
+            expected.push_back(lhs.square());
+        }
+        for (TBigInt::TThresholds forced : { TBigInt::TThresholds{ 8, 16, 32, SIZE_MAX }, TBigInt::TThresholds{ 8, 16, SIZE_MAX, SIZE_MAX } }) {
+            TBigInt::setThresholds(forced);
+            assert(TBigInt::multiplyTier(100, 100) == (forced.toom4 == 32 ? TBigInt::TMultiplyTier::ToomCook4 : TBigInt::TMultiplyTier::ToomCook3));
+            for (size_t i = 0; i < operands.size(); ++i) {
+                assert(operands[i].first * operands[i].second == expected[2 * i]);
+                assert(operands[i].second * operands[i].first == expected[2 * i]);
+                assert(operands[i].first.square() == expected[2 * i + 1]);
+            }
+        }
+        TBigInt::setThresholds(tuned);
+    }
+    {                                       // multiplication tiers
+        using TTier = TBigInt::TMultiplyTier;
+        TBigInt::TThresholds tuned = TBigInt::getThresholds();
+        for (auto [size, tier] : std::vector<std::pair<size_t, TTier>>{    // every default tier runs from its threshold on
+            { tuned.karatsuba - 1, TTier::Schoolbook }, { tuned.karatsuba, TTier::Karatsuba }, { tuned.toom3, TTier::ToomCook3 },
+            { tuned.toom4, TTier::ToomCook4 }, { tuned.ntt, TTier::Ntt }
+        }) {
+            assert(TBigInt::multiplyTier(size, size) == tier);
+        }
+        TBigInt::setThresholds({ 24, 768, 2048, 16384 });
+        for (auto [lhs, rhs, tier] : std::vector<std::tuple<size_t, size_t, TTier>>{
+            { 10, 10, TTier::Schoolbook }, { 5000, 23, TTier::Schoolbook }, { 24, 24, TTier::Karatsuba },
+            { 767, 767, TTier::Karatsuba }, { 768, 768, TTier::ToomCook3 }, { 1151, 768, TTier::ToomCook3 },
+            { 1152, 768, TTier::Karatsuba }, { 2047, 2047, TTier::ToomCook3 }, { 2048, 2048, TTier::ToomCook4 },
+            { 2730, 2048, TTier::ToomCook4 }, { 2731, 2048, TTier::ToomCook3 }, { 16383, 16383, TTier::ToomCook4 },
+            { 16384, 16384, TTier::Ntt }, { 100000, 16384, TTier::Ntt }, { nttMaxLength, 16384, TTier::Karatsuba }
+        }) {
+            assert(TBigInt::multiplyTier(lhs, rhs) == tier);
+            assert(TBigInt::multiplyTier(rhs, lhs) == tier);
+        }
+        bool thrown = false;
+        try {
+            TBigInt::setThresholds({ 24, 768, 2048, 1024 });    // toom-4 behind ntt
+        } catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+        TBigInt::setThresholds(tuned);
+    }
+    {                                       // accumulator
+        std::vector<TBigInt> column;
+        for (size_t i = 0; i < 2000; ++i) {
+            column.emplace_back(generateRandomNumber(1 + i % 97));
+        }
+        TBigInt expected;
+        TBigIntAccumulator acc;
+        for (const TBigInt &n : column) {
+            expected += n;
+        }
+        acc.add(column.data(), column.size());
+        assert(acc.result() == expected);
+        acc.sub(column.data(), column.size());
+        assert(acc.result() == TBigInt());
+        acc -= TBigInt("-" + std::string(300, '9'));
+        acc += TBigInt(1);
+        assert(acc.result() == TBigInt("1" + std::string(300, '0')));
+        acc.clear();
+        assert(acc.result() == TBigInt());
+    }
+    {                                       // fused products
+        for (auto [lhsLength, rhsLength] : std::vector<std::pair<size_t, size_t>>{ { 5, 3 }, { 200, 100 }, { 3000, 2000 }, { 12000, 11000 } }) {
+            std::vector<TBigInt> a, b;
+            for (bool negative : { false, true }) {
+                TBigInt x(generateRandomNumber(lhsLength)), y(generateRandomNumber(rhsLength));
+                a.push_back((x < 0) == negative ? x : -x);
+                b.push_back((y < 0) == negative ? y : -y);
+            }
+            for (const TBigInt &x : a) {
+                for (const TBigInt &y : b) {
+                    TBigInt c(y), d(x), e(generateRandomNumber(lhsLength + 5)), res("12345");
+                    res = lazy(x) * y + lazy(c) * d - e;
+                    assert(res == x * y + c * d - e);
+                    assert(TBigInt(e - lazy(x) * y) == e - x * y);
+                    assert(TBigInt(-(lazy(x) * x) + 1) == TBigInt(1) - x * x);
+                    assert(TBigInt(c).addProduct(x, y) == c + x * y);
+                    assert(TBigInt(e).subProduct(x, y) == e - x * y);
+                    assert(TBigInt(x * y).subProduct(y, x) == TBigInt());
+                    TBigInt prev(c);
+                    c = lazy(c) * d + c;
+                    assert(c == prev * d + prev);
+                    c.addProduct(c, c);
+                    assert(c == (prev * d + prev) * (prev * d + prev + 1));
+                }
+            }
+        }
+    }
+    {                                       // binary format
+        std::vector<TBigInt> numbers = { TBigInt(), TBigInt(7), TBigInt("-4294967296"), TBigInt(generateRandomNumber(5000)), TBigInt(generateRandomNumber(3000)) };
+        std::ostringstream out;
+        for (const TBigInt &n : numbers) {
+            writeBinary(out, n);
+        }
+        std::string bytes = out.str();
+        assert(bytes.size() == 5 * binaryHeaderSize + 4 * (0 + 1 + 2) + binarySize(numbers[3]) + binarySize(numbers[4]) - 2 * binaryHeaderSize);
+        std::istringstream in(bytes);
+        TBigInt n;
+        for (const TBigInt &expected : numbers) {
+            assert(readBinary(in, n) && n == expected);
+        }
+        assert(!readBinary(in, n) && n == numbers.back());
+        std::string huge = bytes.substr(0, 8) + std::string("\0\0\0\0\0\1\0\0", 8) + bytes.substr(binaryHeaderSize, 64);   // 2^40 limbs announced
+        std::string zeroTop = bytes.substr(binarySize(numbers[0]), 8) + std::string("\2\0\0\0\0\0\0\0\7\0\0\0\0\0\0\0", 16);
+        for (std::string bad : { std::string(64, '\xff'), huge, zeroTop }) {
+            std::istringstream badIn(bad);
+            assert(!readBinary(badIn, n) && badIn.fail() && n == numbers.back());
+        }
+
+        const char *first = bytes.data(), *last = bytes.data() + bytes.size();
+        for (const TBigInt &expected : numbers) {
+            auto [ptr, ec] = fromBinary(first, last, n);
+            assert(ec == std::errc() && n == expected);
+            first = ptr;
+        }
+        assert(first == last);
+        assert(toBinary(bytes.data(), bytes.data() + binaryHeaderSize + 3, numbers[2]).ec == std::errc::value_too_large);
+        for (std::string bad : { bytes.substr(0, 15), bytes.substr(binaryHeaderSize, binaryHeaderSize + 3), std::string("TBI\2") + bytes.substr(4, 12) }) {
+            assert(fromBinary(bad.data(), bad.data() + bad.size(), n).ec == std::errc::invalid_argument && n == numbers.back());
+        }
+
+        const std::string path = "binary_test.bin";
+        {
+            std::ofstream file(path, std::ios::binary);
+            file.write(bytes.data(), bytes.size());
+        }
+        {
+            TMappedFile file(path);
+            std::vector<TBigIntView> views;
+            for (const char *ptr = file.begin(); ptr != file.end(); ) {
+                views.emplace_back();
+                auto res = viewBinary(ptr, file.end(), views.back());
+                assert(res.ec == std::errc());
+                ptr = res.ptr;
+            }
+            size_t offset = binarySize(numbers[0]) + binarySize(numbers[1]) + binarySize(numbers[2]) + binaryHeaderSize;
+            assert(views.size() == numbers.size() && views[3].limbs().begin() == reinterpret_cast<const uint32_t*>(file.begin() + offset));
+            for (size_t i = 0; i < numbers.size(); ++i) {
+                assert(views[i].value() == numbers[i]);
+                assert(views[i] * views[4] == numbers[i] * numbers[4]);
+                assert(views[i] * numbers[3] == numbers[i] * numbers[3]);
+            }
+        }
+        std::remove(path.c_str());
+    }
+    {                                       // literals
+        static_assert(TBigIntLiteral<'4', '2', '9', '4', '9', '6', '7', '2', '9', '7'>::limbs[1] == 1);
+        static_assert(TBigIntLiteral<'0'>::limbs.empty() && TBigIntLiteral<'0', 'x', '0', '0', '1'>::limbs.size() == 1);
+        assert((123456789012345678901234567890123456789012345678901234567890_big).value() == TBigInt("123456789012345678901234567890123456789012345678901234567890"));
+        assert(TBigInt(-0xffffffff'ffffffff'ffffffff_big) == TBigInt("-79228162514264337593543950335"));
+        assert(TBigInt(0b1'0000'0000'0000'0000'0000'0000'0000'0000_big) == TBigInt("4294967296"));
+        assert(TBigInt(0777_big) == TBigInt(511) && TBigInt(0_big) == TBigInt() && TBigInt(-0_big) == TBigInt());
+        TBigInt prime("2305843009213693951");
+        assert(2305843009213693951_big * prime == prime * prime);
+        assert(-2305843009213693951_big * -2305843009213693951_big == prime * prime);
+        auto first = 18446744073709551616_big, second = 18446744073709551616_big;
+        assert(first.limbs().begin() == second.limbs().begin());   // one static array per literal
+
+        TBigInt x("-18446744073709551621");
+        assert(x + 5_big == -18446744073709551616_big && 5_big - x == 18446744073709551626_big);
+        assert(x / 4294967296_big == -4294967296_big && x % 4294967296_big == -5_big);
+        assert(prime % 1000_big == 951_big && (prime * prime) / prime == 2305843009213693951_big);
+        assert(x < -18446744073709551620_big && -18446744073709551622_big < x && 0_big > x && x <= x && 2_big >= -3_big);
+        assert(first == second && first != -second && -first < second && first <= 18446744073709551617_big);
+        bool thrown = false;
+        try {
+            x % 0_big;
+        } catch (const std::domain_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {                                       // gcd
+        assert(gcd(TBigInt(), TBigInt()) == TBigInt() && gcd(TBigInt(-12), TBigInt()) == TBigInt(12));
+        assert(gcd(TBigInt(-12), TBigInt(18)) == TBigInt(6) && lcm(TBigInt(-4), TBigInt(6)) == TBigInt(12));
+        assert(lcm(TBigInt(), TBigInt(5)) == TBigInt());
+        assert(invmod(TBigInt(3), TBigInt(7)) == TBigInt(5) && invmod(TBigInt(-3), TBigInt(7)) == TBigInt(2));
+        size_t thrown = 0;
+        for (auto [val, mod] : std::vector<std::pair<int, int>>{ { 4, 6 }, { 3, 0 }, { 3, -7 } }) {
+            try {
+                invmod(TBigInt(val), TBigInt(mod));
+            } catch (const std::domain_error&) {
+                ++thrown;
+            }
+        }
+        assert(thrown == 3);
+
+        TBigInt fib(1), next(1);                   // all quotients one, the slowest case for euclid
+        for (size_t i = 0; i < 3000; ++i) {
+            std::tie(fib, next) = std::make_pair(next, fib + next);
+        }
+        auto [one, s, t] = gcdext(next, fib);
+        assert(one == TBigInt(1) && s * next + t * fib == one && gcd(next, fib) == one);
+
+        for (size_t length : { 30, 2000, 110000 }) {
+            TBigInt common(generateRandomNumber(length / 3 + 1)), a(generateRandomNumber(length)), b(generateRandomNumber(length));
+            common = common < 0 ? -common : common;
+            TBigInt g = gcd(a, b);
+            assert(gcd(a * common, b * common) == g * common);
+            auto [h, u, v] = gcdext(a * common, b * common);
+            assert(h == g * common && u * a * common + v * b * common == h);
+            TBigInt modulus = b < 0 ? -b : b;
+            assert(u >= 0 && u < modulus / g);
+            if (g == TBigInt(1)) {
+                TBigInt rem = a * invmod(a, modulus) % modulus;
+                assert(rem == TBigInt(1) || rem == TBigInt(1) - modulus);
+            }
+        }
+    }
+    {                                       // shifts
+        TBigInt n("-123456789012345678901234567890");
+        assert((n << 0) == n && (n << 100) == n * TBigInt("1267650600228229401496703205376"));
+        assert(((n << 77) >> 77) == n && (TBigInt(5) >> 1) == TBigInt(2) && (TBigInt(-5) >> 1) == TBigInt(-3));
+        assert((n >> 200) == TBigInt(-1) && (-n >> 200) == TBigInt() && (TBigInt(-4) >> 2) == TBigInt(-1));
+        assert(TBigInt().bitLength() == 0 && TBigInt("4294967296").bitLength() == 33 && n.bitLength() == 97);
+    }
+    {                                       // mixed signs
+        TBigInt n("-123456789012345678901234567890"), zero;
+        assert(n + -n == zero && !(n - n < zero) && zero - zero == zero && zero - n == -n && n + zero == n);
+        for (size_t length : { 1, 30, 300 }) {
+            TBigInt lhs(generateRandomNumber(length)), rhs(generateRandomNumber(length / 2 + 1));
+            for (const TBigInt &val : { rhs, -rhs, lhs, -lhs }) {
+                TBigInt sum = lhs + val, diff = lhs - val;
+                assert(sum - val == lhs && diff + val == lhs && val + lhs == sum && val - lhs == -diff);
+            }
+        }
+    }
+    {                                       // word operands
+        TBigInt n("-123456789012345678901234567890"), big(UINT64_MAX);
+        assert(TBigInt(4294967295u) == TBigInt("4294967295") && big == TBigInt("18446744073709551615"));
+        assert(TBigInt(INT64_MIN) == TBigInt("-9223372036854775808") && static_cast<int64_t>(TBigInt(INT64_MIN)) == INT64_MIN);
+        assert(static_cast<uint64_t>(big) == UINT64_MAX && static_cast<int>(TBigInt(-7)) == -7 && static_cast<uint64_t>(big + 1) == 0);
+        assert(3 * n == n + n + n && 1 - n == -(n - 1u) && (n += 1) == TBigInt("-123456789012345678901234567889"));
+        for (size_t length : { 1, 9, 10, 19, 20, 40, 700 }) {
+            TBigInt num(generateRandomNumber(length));
+            for (int64_t word : { INT64_C(0), INT64_C(1), INT64_C(-3), INT64_C(4294967296), INT64_MIN, INT64_MAX }) {
+                TBigInt val(word), acc = num;
+                assert(num + word == num + val && num - word == num - val && num * word == num * val && word - num == val - num);
+                assert((acc += word) == num + val && (acc -= word) == num && (acc *= word) == num * val);
+                if (word) {
+                    auto [quot, rem] = num.divmod(word);
+                    assert(quot == num / val && TBigInt(rem) == num % val);
+                }
+            }
+            auto [quot, rem] = num.divmod(UINT64_MAX);
+            assert(quot == num / big && TBigInt(rem) == (num < 0 ? -(num % big) : num % big));
+        }
+    }
+    {                                       // roots
+        assert(isqrt(TBigInt()) == TBigInt() && isqrt(TBigInt(15)) == TBigInt(3) && isqrt(TBigInt(16)) == TBigInt(4));
+        assert(iroot(TBigInt(-27), 3) == TBigInt(-3) && iroot(TBigInt(-26), 3) == TBigInt(-2) && iroot(TBigInt(7), 1) == TBigInt(7));
+        assert(iroot(TBigInt("1000000000000"), 4000000000u) == TBigInt(1));
+        for (uint32_t k : { 60, 2000, 5000 }) {               // short roots of a large degree
+            TBigInt power(1);
+            for (uint32_t i = 0; i < k; ++i) {
+                power *= 12345;
+            }
+            assert(iroot(power, k) == TBigInt(12345) && iroot(power - 1, k) == TBigInt(12344) && iroot(power + 1, k) == TBigInt(12345));
+        }
+        size_t thrown = 0;
+        for (auto [num, k] : std::vector<std::pair<int, uint32_t>>{ { -1, 2 }, { -16, 4 }, { 5, 0 } }) {
+            try {
+                iroot(TBigInt(num), k);
+            } catch (const std::domain_error&) {
+                ++thrown;
+            }
+        }
+        assert(thrown == 3);
+        for (size_t length : { 5, 40, 700, 30000 }) {
+            TBigInt num(generateRandomNumber(length));
+            num = num < 0 ? -num : num;
+            for (uint32_t k : { 2, 3, 7 }) {
+                TBigInt root = iroot(num, k), bound = root + 1, power(1), next(1);
+                for (uint32_t i = 0; i < k; ++i) {
+                    power *= root;
+                    next *= bound;
+                }
+                assert(power <= num && num < next);
+            }
+            TBigInt root = isqrt(num);
+            assert(isPerfectSquare(root.square()) && !isPerfectSquare(root.square() + root * 2 + 3));
+            assert(isqrt(root.square() - 1) == root - 1 || root == 0);
+        }
+    }
+    {                                       // simd kernels
+        TBigInt limb("4294967296"), ones(1);
+        for (size_t i = 0; i < 300; ++i) {
+            ones *= limb;
+        }
+        ones -= 1;                          // long runs of all-ones limbs carry through every lane
+        std::vector<TBigInt> operands = { ones, ones + 1, ones * limb, TBigInt(generateRandomNumber(3000)), TBigInt(generateRandomNumber(2990)) };
+        std::vector<TBigInt> expected;
+        std::vector<bool> less;
+        setSimdLevel(TSimdLevel::Scalar);
+        for (const TBigInt &lhs : operands) {
+            for (const TBigInt &rhs : operands) {
+                expected.push_back(lhs + rhs);
+                expected.push_back(lhs - rhs);
+                less.push_back(lhs < rhs);
+            }
+        }
+        for (TSimdLevel level : { TSimdLevel::Sse2, TSimdLevel::Avx2 }) {
+            setSimdLevel(level);
+            for (size_t i = 0, k = 0; i < operands.size(); ++i) {
+                for (size_t j = 0; j < operands.size(); ++j, ++k) {
+                    assert(operands[i] + operands[j] == expected[2 * k]);
+                    assert(operands[i] - operands[j] == expected[2 * k + 1]);
+                    assert((operands[i] < operands[j]) == less[k]);
+                }
+            }
+        }
+        assert(ones + 1 - 1 == ones && ones + 1 == limb * (ones + 1) / limb);
+    }
+    {                                       // limb kernels
+        std::vector<uint32_t> src = { 0xffffffff, 0xffffffff, 7, 0, 0xffffffff, 0x80000000 }, other = { 5, 0, 0xffffffff, 1, 2, 3 };
+        size_t n = src.size();
+        auto value = [](const std::vector<uint32_t> &limbs) { return TBigInt(TBigIntView(TVector::TVectorView(limbs.size(), limbs.data()), false)); };
+        auto above = [n](uint32_t limb) { return TBigInt(limb) << (TBigInt::limbBits * n); };
+        TBigInt num = value(src), addend = value(other);
+        for (uint32_t limb : { 0u, 1u, 3u, 0xffffffffu }) {
+            std::vector<uint32_t> res(n), acc = other;
+            uint32_t top = add1(res.data(), src.data(), n, limb);
+            assert(value(res) + above(top) == num + limb);
+            top = sub1(res.data(), src.data(), n, limb);
+            assert(value(res) - above(top) == num - limb);
+            top = mul1(res.data(), src.data(), n, limb);
+            assert(value(res) + above(top) == num * limb);
+            top = addMul1(acc.data(), src.data(), n, limb);
+            assert(value(acc) + above(top) == addend + num * limb);
+            acc = other;
+            top = subMul1(acc.data(), src.data(), n, limb);
+            assert(value(acc) - above(top) == addend - num * limb);
+        }
+        for (uint32_t bits : { 0u, 1u, 17u, 31u }) {
+            std::vector<uint32_t> res(n), inPlace = src;
+            uint32_t out = shiftLeftN(res.data(), src.data(), n, bits);
+            assert(value(res) + above(out) == num << bits);
+            shiftLeftN(inPlace.data(), inPlace.data(), n, bits);
+            assert(inPlace == res);
+            out = shiftRightN(res.data(), src.data(), n, bits);
+            assert(value(res) == num >> bits && out == (bits ? src[0] << (TBigInt::limbBits - bits) : 0));
+        }
+    }
+    {                                       // compound assignment
+        TBigInt sum, step("4294967295");
+        for (uint32_t i = 0; i < 1000; ++i) {
+            sum += step;
+        }
+        assert(sum == step * 1000);
+        sum -= step * 1001;
+        assert(sum == -step);
+        sum += sum;
+        assert(sum == step * -2);
+        sum *= TBigInt("-18446744073709551616");
+        assert(sum == step * 2 * TBigInt("18446744073709551616"));
+        sum -= sum;
+        assert(sum == 0);
+
+        TBigInt n = 1;
+        assert(n-- == 1 && n == 0);
+        assert(--n == -1 && ++n == 0 && ++n == 1);
+        n = TBigInt("-18446744073709551616");
+        assert(++n == TBigInt("-18446744073709551615") && --n == TBigInt("-18446744073709551616"));
+        n = TBigInt("18446744073709551615");
+        assert(n++ == TBigInt("18446744073709551615") && n == TBigInt("18446744073709551616"));
+    }
+    {                                       // operator/ and operator%
+        std::vector<std::tuple<std::string, std::string, std::string, std::string>> expressions = {
+            std::make_tuple("41510012747626900767766071304626751312262276372208574991117898526017505", "043873897487123123873456", "946120931239582323409234985283472319871231095034", "1"),
+            std::make_tuple("-458976452934282431092350394123", "32434983794539845837329453749", "-14", "-4886679810724589369738041637"),
+            std::make_tuple("234897234", "-123812398129954", "0", "234897234"),
+            std::make_tuple("-18446744073709551616", "-4294967295", "4294967297", "-1"),
+            std::make_tuple("0", "-7", "0", "0")
+        };
+        for (const auto &[lhs, rhs, quot, rem] : expressions) {
+            std::ostringstream os;
+            os << TBigInt(lhs) / TBigInt(rhs) << ' ' << TBigInt(lhs) % TBigInt(rhs);
+            assert(os.str() == quot + " " + rem);
+        }
+        TBigInt den(std::string(3000, '7')), quot(std::string(9000, '3')), rem(std::string(2999, '5'));
+        auto [q, r] = (den * quot + rem).divmod(den);
+        assert(q == quot && r == rem);
+        bool thrown = false;
+        try {
+            den / TBigInt();
+        } catch (const std::domain_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    {                                       // powmod
+        std::vector<std::tuple<std::string, std::string, std::string, std::string>> expressions = {
+            std::make_tuple("4", "13", "497", "445"),
+            std::make_tuple("-2", "3", "5", "2"),
+            std::make_tuple("123", "0", "1", "0"),
+            std::make_tuple("123", "0", "7", "1"),
+            std::make_tuple("3", "100", "18446744073709551616", "15462121228172006353"),
+            std::make_tuple("-7", "77777", "1180591620717411303426", "299498256512580686801")
+        };
+        for (const auto &[base, exp, mod, res] : expressions) {
+            assert(powmod(TBigInt(base), TBigInt(exp), TBigInt(mod)) == TBigInt(res));
+        }
+        for (size_t bits : { 521, 4423 }) {     // fermat's little theorem on mersenne primes
+            TBigInt prime = 1;
+            for (size_t i = 0; i < bits; ++i) {
+                prime += prime;
+            }
+            --prime;
+            TMontgomery context(prime);
+            assert(powmod(3, prime - 1, prime) == 1);
+            assert(context.pow(TBigInt("-123456789123456789"), prime - 1) == 1);
+            assert(context.pow(prime + 2, prime) == 2);
+        }
+        std::vector<void (*)()> checks = {
+            [] { powmod(2, -1, 7); },
+            [] { powmod(2, 3, 0); },
+            [] { TMontgomery(TBigInt(10)); }
+        };
+        size_t thrown = 0;
+        for (auto check : checks) {
+            try {
+                check();
+            } catch (const std::domain_error&) {
+                ++thrown;
+            }
+        }
+        assert(thrown == 3);
+    }
     {                                       // operator<=>
         TBigInt lhs("2304923123095045623042375938439");
         TBigInt rhs(lhs);
@@ -255,11 +895,263 @@ void TestBigInt() {
         rhs = TBigInt("-0");
 
         assert(lhs == rhs);
+
+        lhs = TBigInt("-9999999999");
+        rhs = lhs;
+
+        assert(!(lhs < rhs));
+        assert(lhs - rhs == 0);
     }
     std::cerr << "TestBigInt is OK" << std::endl;
 }
 
-int main() {
+// script.py as the reference, started once for the whole run: expressions go down a pipe
+// in batches ended by an empty line and the answers come back in the same order.
+class TOracle {
+private:
+    pid_t pid;
+    FILE *requests;
+    FILE *answers;
+public:
+    TOracle() : pid(-1), requests(nullptr), answers(nullptr) {
+        int down[2], up[2];
+        if (pipe(down) || pipe(up)) {
+            throw std::system_error(errno, std::generic_category(), "TOracle: pipe");
+        }
+        pid = fork();
+        if (pid < 0) {
+            throw std::system_error(errno, std::generic_category(), "TOracle: fork");
+        } else if (!pid) {
+            dup2(down[0], STDIN_FILENO);
+            dup2(up[1], STDOUT_FILENO);
+            for (int fd : { down[0], down[1], up[0], up[1] }) {
+                close(fd);
+            }
+            execlp("python3", "python3", "script.py", "--batch", static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        close(down[0]);
+        close(up[1]);
+        signal(SIGPIPE, SIG_IGN);                       // a dead script shows up as a short answer
+        requests = fdopen(down[1], "w");
+        answers = fdopen(up[0], "r");
+    }
+
+    TOracle(const TOracle&) = delete;
+    TOracle& operator=(const TOracle&) = delete;
+
+    ~TOracle() {
+        fclose(requests);                               // end of input stops the script
+        fclose(answers);
+        waitpid(pid, nullptr, 0);
+    }
+
+    std::vector<std::string> evaluate(const std::vector<std::string> &expressions) {
+        for (const std::string &expression : expressions) {
+            fprintf(requests, "%s\n", expression.c_str());
+        }
+        fputc('\n', requests);
+        fflush(requests);
+        std::vector<std::string> res;
+        char *line = nullptr;
+        size_t capacity = 0;
+        for (ssize_t len; res.size() < expressions.size() && (len = getline(&line, &capacity, answers)) > 0; ) {
+            res.emplace_back(line, len - (line[len - 1] == '\n'));
+        }
+        free(line);
+        if (res.size() != expressions.size()) {
+            throw std::runtime_error("TOracle: script.py stopped answering");
+        }
+        return res;
+    }
+};
+
+// Python's hex(): "0x0", "-0x1f".
+std::string toHex(const TBigInt &obj) {
+    TBigIntView view(obj);
+    std::string res = view.negative() ? "-0x" : "0x";
+    char digits[9];
+    for (size_t i = view.limbs().size(); i--; ) {
+        std::snprintf(digits, sizeof(digits), i + 1 == view.limbs().size() ? "%x" : "%08x", view.limbs()[i]);
+        res += digits;
+    }
+    return view.limbs().empty() ? res + "0" : res;
+}
+
+struct TOperand {
+    std::string text;
+    TBigInt value;
+    bool hex;
+};
+
+// Random expressions checked against script.py in bulk. Operands are zeros, short decimal
+// strings around the 9 digit chunks, or random limbs on both sides of every multiplication
+// tier and of burnikel-ziegler (80 limbs). Those go out in decimal up to decimalLimbs and
+// in hex above, the ntt ones only for the cheap operations in the occasional huge case.
+void TestDifferential(size_t cases, uint32_t seed) {
+    constexpr size_t batchSize = 10000, decimalLimbs = 600, largeLimbs = 3000, smallLimbs = 100;
+    const std::array<size_t, 11> digits = { 1, 5, 9, 10, 18, 19, 20, 38, 39, 40, 100 };
+    const std::array<std::string, 23> operations = {
+        "+", "-", "*", "/", "%", "<<", ">>", "cmp", "gcd", "lcm", "gcdext", "invmod", "powmod", "isqrt", "iroot",
+        "addmul", "submul", "+w", "-w", "*w", "/w", "%w", "/u"     // w: an int64_t operand, u: uint64_t
+    };
+    TBigInt::TThresholds tiers = TBigInt::getThresholds();
+    std::vector<size_t> limbCounts, hugeCounts;
+    for (size_t boundary : { size_t(1), size_t(2), tiers.karatsuba, size_t(80), tiers.toom3, tiers.toom4, tiers.ntt }) {
+        for (size_t limbs : { boundary - 1, boundary, boundary + 1 }) {
+            if (limbs && 2 * limbs <= nttMaxLength) {
+                (limbs <= largeLimbs ? limbCounts : hugeCounts).push_back(limbs);
+            }
+        }
+    }
+    std::mt19937 gen(seed);
+    std::cerr << "TestDifferential: --seed " << seed << std::endl;
+    auto fromLimbs = [&](size_t limbs) -> TOperand {
+        std::vector<uint32_t> data(limbs);
+        std::generate(data.begin(), data.end(), std::ref(gen));
+        data.back() |= 1;
+        TBigInt value(TBigIntView(TVector::TVectorView(data.size(), data.data()), gen() & 1));
+        if (limbs > decimalLimbs) {
+            return { toHex(value), value, true };
+        }
+        std::ostringstream os;
+        os << value;
+        return { os.str(), TBigInt(os.str()), false };     // parsed back, so both directions get used
+    };
+    auto operand = [&](size_t maxLimbs) -> TOperand {
+        size_t kind = gen() % 16;
+        if (kind == 0) {
+            std::string zero = gen() & 1 ? "0" : "-0";
+            return { zero, TBigInt(zero), false };
+        } else if (kind < 8) {
+            std::string text = generateRandomNumber(digits[gen() % digits.size()], gen);
+            return { text, TBigInt(text), false };
+        }
+        size_t limbs = limbCounts[gen() % limbCounts.size()];
+        return fromLimbs(limbs <= maxLimbs ? limbs : 1 + gen() % maxLimbs);
+    };
+    auto word = [&](bool isSigned) -> std::pair<int64_t, uint64_t> {
+        uint64_t bits = static_cast<uint64_t>(gen()) << 32 | gen();
+        bits = gen() & 1 ? bits : bits >> (gen() % 64);     // short words as often as full ones
+        int64_t magnitude = static_cast<int64_t>(bits >> 1);
+        int64_t signedWord = gen() % 64 == 0 ? INT64_MIN : gen() & 1 ? -magnitude : magnitude;
+        return { signedWord, isSigned ? 0 : bits };
+    };
+
+    TOracle oracle;
+    size_t hugeCases = 0;
+    for (size_t done = 0; done < cases; done += batchSize) {
+        std::vector<std::string> expressions, results;
+        for (size_t i = 0; i < std::min(batchSize, cases - done); ++i) {
+            size_t op = gen() % operations.size();
+            const std::string &name = operations[op];
+            std::vector<TOperand> args;
+            if (op < 3 || op == 7) {                        // + - * cmp, now and then with ntt sized operands
+                bool huge = !hugeCounts.empty() && gen() % 1000 == 0;
+                hugeCases += huge;
+                for (size_t j = 0; j < 2; ++j) {
+                    args.push_back(huge ? fromLimbs(hugeCounts[gen() % hugeCounts.size()]) : operand(largeLimbs));
+                }
+            } else if (op < 5 || op == 13) {                // / % isqrt
+                args = { operand(largeLimbs), operand(largeLimbs) };
+            } else if (op < 7 || op == 14) {                // << >> iroot: a small count
+                args = { operand(largeLimbs), { std::to_string(gen() % (op == 14 ? 41 : 300)), TBigInt(), false } };
+                args[1].value = TBigInt(args[1].text);
+            } else if (op < 12) {                           // the gcd family
+                args = { operand(smallLimbs), operand(smallLimbs) };
+            } else if (op == 12) {
+                args = { operand(smallLimbs), operand(4), operand(smallLimbs) };
+            } else if (op < 17) {
+                args = { operand(largeLimbs), operand(largeLimbs), operand(largeLimbs) };
+            } else {
+                auto [signedWord, unsignedWord] = word(op != 22);
+                std::string text = op == 22 ? std::to_string(unsignedWord) : std::to_string(signedWord);
+                args = { operand(largeLimbs), { text, TBigInt(text), false } };
+            }
+            if (op == 13) {
+                args.pop_back();
+            }
+            bool hex = false;
+            std::string expression = args[0].text + " " + (op < 17 ? name : name.substr(0, 1));
+            for (size_t j = 0; j < args.size(); ++j) {
+                hex = hex || args[j].hex;
+                expression += j ? " " + args[j].text : "";
+            }
+            auto show = [&](const TBigInt &obj) {
+                if (hex) {
+                    return toHex(obj);
+                }
+                std::ostringstream os;
+                os << obj;
+                return os.str();
+            };
+
+            const TBigInt &a = args[0].value, &b = args.size() > 1 ? args[1].value : a;
+            auto [signedWord, unsignedWord] = std::make_pair(static_cast<int64_t>(b), static_cast<uint64_t>(b));
+            std::string value;
+            try {
+                switch (op) {
+                case 0: value = show(a + b); break;
+                case 1: value = show(a - b); break;
+                case 2: value = show(a * b); break;
+                case 3: value = show(a / b); break;
+                case 4: value = show(a % b); break;
+                case 5: value = show(a << static_cast<size_t>(b)); break;
+                case 6: value = show(a >> static_cast<size_t>(b)); break;
+                case 7: value = show(TBigInt(a < b ? -1 : b < a ? 1 : 0)); break;
+                case 8: value = show(gcd(a, b)); break;
+                case 9: value = show(lcm(a, b)); break;
+                case 10: {
+                    auto [g, x, y] = gcdext(a, b);
+                    value = show(g) + " " + show(x) + " " + show(y);
+                    break;
+                }
+                case 11: value = show(invmod(a, b)); break;
+                case 12: value = show(powmod(a, b, args[2].value)); break;
+                case 13: value = show(isqrt(a)); break;
+                case 14: value = show(iroot(a, static_cast<uint32_t>(b))); break;
+                case 15: value = show(TBigInt(a).addProduct(b, args[2].value)); break;
+                case 16: value = show(TBigInt(a).subProduct(b, args[2].value)); break;
+                case 17: value = show(a + signedWord); break;
+                case 18: value = show(a - signedWord); break;
+                case 19: value = show(a * signedWord); break;
+                case 20: value = show(a.divmod(signedWord).first); break;
+                case 21: value = show(TBigInt(a.divmod(signedWord).second)); break;
+                default: value = show(a.divmod(unsignedWord).first); break;
+                }
+            } catch (const std::domain_error&) {
+                value = "error";
+            }
+            expressions.push_back(std::move(expression));
+            results.push_back(std::move(value));
+        }
+        std::vector<std::string> expected = oracle.evaluate(expressions);
+        for (size_t i = 0; i < expressions.size(); ++i) {
+            if (results[i] != expected[i]) {
+                auto cut = [](const std::string &text) { return text.size() > 1000 ? text.substr(0, 1000) + "..." : text; };
+                std::cerr << cut(expressions[i]) << "\n  gives " << cut(results[i]) << "\n  expected " << cut(expected[i])
+                          << "\nrerun with --seed " << seed << std::endl;
+                assert(false);
+            }
+        }
+    }
+    std::cerr << "TestDifferential is OK, " << cases << " cases, " << hugeCases << " of them ntt sized" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::string(argv[1]) == "--differential") {    // [cases] [--seed N]
+        size_t cases = 100'000;
+        uint32_t seed = std::random_device()();
+        for (int i = 2; i < argc; ++i) {
+            if (std::string(argv[i]) == "--seed" && i + 1 < argc) {
+                seed = std::stoul(argv[++i]);
+            } else {
+                cases = std::stoul(argv[i]);
+            }
+        }
+        TestDifferential(cases, seed);
+        return 0;
+    }
     TestVector();
     TestBigInt();
     return 0;
@@ -0,0 +1,156 @@
+#include "montgomery.h"
+#include "kernels.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+static size_t bitLength(TVector::TVectorView data) {
+    return data.empty() ? 0 : TBigInt::limbBits * data.size() - __builtin_clz(data.begin()[data.size() - 1]);
+}
+
+static bool testBit(TVector::TVectorView data, size_t idx) {
+    return data[idx / TBigInt::limbBits] >> idx % TBigInt::limbBits & 1;
+}
+
+static size_t windowBits(size_t bits) {
+    return bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+}
+
+TMontgomery::TMontgomery(const TBigInt &m)
+    : size(m.data.size())
+    , mod(m)
+    , modInverse()
+    , rSquared()
+    , scratch()
+    , wordInverse()
+{
+    if (m.neg || m.data.empty() || !(m.data[0] & 1)) {
+        throw std::domain_error("TMontgomery: the modulus must be odd and positive");
+    }
+    uint32_t inv = m.data[0];                           // right to 3 bits, each step doubles them
+    for (size_t i = 0; i < 4; ++i) {
+        inv *= 2 - m.data[0] * inv;
+    }
+    wordInverse = -inv;
+
+    if (size >= productReductionThreshold) {            // digits q of q * m = -1 mod R, one limb at a time
+        modInverse.resize(size);
+        TVector rest;
+        rest.resize(size);
+        rest[0] = 1;
+        for (size_t i = 0; i < size; ++i) {
+            uint32_t digit = rest[i] * wordInverse;
+            modInverse[i] = digit;
+            addMul1(rest.begin() + i, m.data.begin(), size - i, digit);
+        }
+    }
+
+    rSquared = (TBigInt(1).shiftLimbs(2 * size) % mod).data;
+    rSquared.resize(size);
+    scratch.resize(size < productReductionThreshold ? 2 * size : 6 * size);
+}
+
+const TBigInt& TMontgomery::modulus() const {
+    return mod;
+}
+
+void TMontgomery::multiply(uint32_t *res, const uint32_t *lhs, const uint32_t *rhs) {
+    TBigInt::multiply(scratch.begin(), { size, lhs }, { size, rhs });   // the same pointer squares
+    reduce(res);
+}
+
+void TMontgomery::reduce(uint32_t *res) {
+    uint32_t *prod = scratch.begin();
+    const uint32_t *m = mod.data.begin();
+    uint64_t over = 0;
+    if (size < productReductionThreshold) {             // clear one low limb per step
+        for (size_t i = 0; i < size; ++i) {
+            uint32_t carry = addMul1(prod + i, m, size, prod[i] * wordInverse);
+            over += static_cast<uint64_t>(prod[i + size]) + carry;
+            prod[i + size] = static_cast<uint32_t>(over);
+            over >>= TBigInt::limbBits;
+        }
+    } else {                                            // q = low * (-m^-1) mod R, then add q * m
+        uint32_t *quot = prod + 2 * size, *corr = quot + 2 * size;
+        TBigInt::multiply(quot, { size, prod }, modInverse);
+        TBigInt::multiply(corr, { size, quot }, mod.data);
+        over = addN(prod, prod, corr, 2 * size);
+    }
+    uint32_t *high = prod + size;                       // below 2m, so one subtraction is enough
+    if (over || compareN(high, m, size) >= 0) {
+        subN(high, high, m, size);
+    }
+    std::copy(high, high + size, res);
+}
+
+TBigInt TMontgomery::pow(const TBigInt &base, const TBigInt &exp) {
+    if (exp.neg) {
+        throw std::domain_error("TMontgomery: negative exponent");
+    }
+    TBigInt rest = base % mod;
+    if (rest.neg) {
+        rest += mod;
+    }
+    size_t bits = bitLength(exp.data), window = windowBits(bits);
+
+    TVector table, acc;                                 // odd powers base, base^3, ..., base^(2^window - 1)
+    table.resize(size << (window - 1));
+    acc.resize(size);
+    std::copy(rest.data.begin(), rest.data.end(), acc.begin());
+    multiply(table.begin(), acc.begin(), rSquared.begin());
+    if (window > 1) {
+        multiply(acc.begin(), table.begin(), table.begin());
+        for (size_t i = size; i < table.size(); i += size) {
+            multiply(table.begin() + i, table.begin() + i - size, acc.begin());
+        }
+    }
+
+    std::fill(acc.begin(), acc.end(), 0);               // one in montgomery form is R mod m
+    acc[0] = 1;
+    multiply(acc.begin(), acc.begin(), rSquared.begin());
+    for (size_t top = bits; top; ) {                    // left to right over windows ending in a one
+        if (!testBit(exp.data, top - 1)) {
+            multiply(acc.begin(), acc.begin(), acc.begin());
+            --top;
+            continue;
+        }
+        size_t low = top > window ? top - window : 0;
+        while (!testBit(exp.data, low)) {
+            ++low;
+        }
+        size_t digit = 0;
+        for (size_t i = top; i-- > low; ) {
+            digit = digit << 1 | testBit(exp.data, i);
+            multiply(acc.begin(), acc.begin(), acc.begin());
+        }
+        multiply(acc.begin(), acc.begin(), table.begin() + (digit >> 1) * size);
+        top = low;
+    }
+
+    TVector unit;
+    unit.resize(size);
+    unit[0] = 1;
+    multiply(acc.begin(), acc.begin(), unit.begin());
+    return TBigInt(acc);
+}
+
+TBigInt powmod(const TBigInt &base, const TBigInt &exp, const TBigInt &mod) {
+    if (mod.neg || mod.data.empty()) {
+        throw std::domain_error("TBigInt: the modulus must be positive");
+    } else if (mod.data[0] & 1) {
+        return TMontgomery(mod).pow(base, exp);
+    } else if (exp.neg) {
+        throw std::domain_error("TBigInt: negative exponent");
+    }
+    TBigInt res = TBigInt(1) % mod, rest = base % mod;  // even moduli fall back to division
+    for (size_t i = bitLength(exp.data); i--; ) {
+        res = res.square() % mod;
+        if (testBit(exp.data, i)) {
+            res = res * rest % mod;
+        }
+    }
+    if (res.neg) {
+        res += mod;
+    }
+    return res;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "bigint.h"
+
+// Precomputed data for one odd modulus. Numbers are kept as size-limb arrays in
+// montgomery form x * R mod m with R = 2^(32 size), so one modular product is a
+// plain product through the multiplication tiers followed by a reduction.
+class TMontgomery {
+private:
+    constexpr static size_t productReductionThreshold = 3072;   // limbs where full-product redc beats the word loop
+
+    size_t size;
+    TBigInt mod;
+    TVector modInverse;                                         // -m^-1 mod R
+    TVector rSquared;                                           // R^2 mod m
+    TVector scratch;                                            // product, quotient and correction
+    uint32_t wordInverse;                                       // -m^-1 mod 2^32
+
+    void multiply(uint32_t*, const uint32_t*, const uint32_t*);
+    void reduce(uint32_t*);
+public:
+    explicit TMontgomery(const TBigInt&);
+
+    const TBigInt& modulus() const;
+    TBigInt pow(const TBigInt&, const TBigInt&);
+};
+
+TBigInt powmod(const TBigInt&, const TBigInt&, const TBigInt&);
@@ -0,0 +1,112 @@
+#include "ntt.h"
+
+#include <algorithm>
+
+using uint128_t = unsigned __int128;
+
+constexpr uint32_t primitiveRoot = 3;                   // shared by all three primes
+constexpr uint32_t firstPrime = 998'244'353;            // 119 * 2^23 + 1
+constexpr uint32_t secondPrime = 167'772'161;           // 5 * 2^25 + 1
+constexpr uint32_t thirdPrime = 469'762'049;            // 7 * 2^26 + 1
+
+template <uint32_t Mod>
+constexpr uint32_t powMod(uint32_t val, uint64_t exp) {
+    uint64_t res = 1, curr = val;
+    for (; exp; exp >>= 1, curr = curr * curr % Mod) {
+        if (exp & 1) {
+            res = res * curr % Mod;
+        }
+    }
+    return res;
+}
+
+template <uint32_t Mod>
+static void transform(TVector &data, bool invert) {
+    size_t n = data.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+    TVector roots;
+    roots.resize(n / 2);
+    for (size_t len = 2; len <= n; len <<= 1) {
+        uint32_t step = powMod<Mod>(primitiveRoot, (Mod - 1) / len);
+        step = invert ? powMod<Mod>(step, Mod - 2) : step;
+        size_t half = len / 2;
+        roots[0] = 1;
+        for (size_t j = 1; j < half; ++j) {
+            roots[j] = static_cast<uint64_t>(roots[j - 1]) * step % Mod;
+        }
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                uint32_t u = data[i + j];
+                uint32_t v = static_cast<uint64_t>(data[i + j + half]) * roots[j] % Mod;
+                data[i + j] = u + v < Mod ? u + v : u + v - Mod;
+                data[i + j + half] = u < v ? u + Mod - v : u - v;
+            }
+        }
+    }
+    if (invert) {
+        uint64_t scale = powMod<Mod>(n, Mod - 2);
+        for (uint32_t &val : data) {
+            val = val * scale % Mod;
+        }
+    }
+}
+
+template <uint32_t Mod>
+static TVector convolve(TVector::TVectorView lhs, TVector::TVectorView rhs, size_t len) {
+    bool square = lhs.begin() == rhs.begin() && lhs.size() == rhs.size();
+    TVector a, b;
+    a.resize_uninitialized(len);
+    std::fill(std::transform(lhs.begin(), lhs.end(), a.begin(), [](uint32_t limb) { return limb % Mod; }), a.end(), 0);
+    if (!square) {
+        b.resize_uninitialized(len);
+        std::fill(std::transform(rhs.begin(), rhs.end(), b.begin(), [](uint32_t limb) { return limb % Mod; }), b.end(), 0);
+    }
+    transform<Mod>(a, false);
+    if (!square) {
+        transform<Mod>(b, false);
+    }
+    for (size_t i = 0; i < len; ++i) {
+        a[i] = static_cast<uint64_t>(a[i]) * (square ? a[i] : b[i]) % Mod;
+    }
+    transform<Mod>(a, true);
+    return a;
+}
+
+TVector nttMultiply(TVector::TVectorView lhs, TVector::TVectorView rhs) {
+    size_t len = 1;
+    while (len < lhs.size() + rhs.size()) {
+        len <<= 1;
+    }
+    TVector first = convolve<firstPrime>(lhs, rhs, len);
+    TVector second = convolve<secondPrime>(lhs, rhs, len);
+    TVector third = convolve<thirdPrime>(lhs, rhs, len);
+
+    constexpr uint64_t product = static_cast<uint64_t>(firstPrime) * secondPrime;
+    constexpr uint64_t firstInv = powMod<secondPrime>(firstPrime % secondPrime, secondPrime - 2);
+    constexpr uint64_t productInv = powMod<thirdPrime>(product % thirdPrime, thirdPrime - 2);
+
+    TVector res;
+    res.resize_uninitialized(lhs.size() + rhs.size() + 1);
+    uint128_t carry = 0;
+    for (size_t i = 0; i < res.size(); ++i) {           // garner's crt, coefficients stay below 2^86
+        if (i + 1 < lhs.size() + rhs.size()) {
+            uint64_t x1 = first[i];
+            uint64_t x2 = (second[i] + secondPrime - x1 % secondPrime) * firstInv % secondPrime;
+            uint64_t low = x1 + x2 * firstPrime;
+            uint64_t x3 = (third[i] + thirdPrime - low % thirdPrime) * productInv % thirdPrime;
+            carry += low + static_cast<uint128_t>(x3) * product;
+        }
+        res[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return res;
+}
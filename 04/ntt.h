@@ -0,0 +1,7 @@
+#pragma once
+
+#include "vector.h"
+
+constexpr size_t nttMaxLength = 1 << 23;               // longest transform of the smallest prime
+
+TVector nttMultiply(TVector::TVectorView, TVector::TVectorView);
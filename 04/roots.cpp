@@ -0,0 +1,87 @@
+#include "roots.h"
+
+#include <cmath>
+#include <stdexcept>
+
+static TBigInt power(const TBigInt &base, uint32_t exp) {
+    TBigInt res(1), sq = base;
+    for (; exp; exp >>= 1) {
+        if (exp & 1) {
+            res *= sq;
+        }
+        if (exp > 1) {
+            sq = sq.square();
+        }
+    }
+    return res;
+}
+
+// 2^(log2(n) / k) from the leading 64 bits of n, a bit above the root. Newton from
+// 2^rootBits would first creep down by a factor of 1 - 1/k per step, about k ln 2 steps.
+static TBigInt rootEstimate(const TBigInt &num, size_t bits, uint32_t k) {
+    size_t shift = bits > 64 ? bits - 64 : 0;
+    double log2Root = (std::log2(static_cast<double>(static_cast<uint64_t>(num >> shift))) + shift) / k;
+    int exp;
+    double mantissa = std::frexp(std::exp2(log2Root) * (1 + 1e-12) + 1, &exp);
+    TBigInt res(static_cast<uint64_t>(std::ldexp(mantissa, 63)));
+    return exp >= 63 ? res << (exp - 63) : res >> (63 - exp);
+}
+
+// floor(n^(1/k)) for n >= 0: the root of n >> k s shifted back by s is below the root by
+// less than 2^s, and one newton step from below squares that error away as long as 2 s
+// stays under the bit length of the root minus log2(k).
+static TBigInt rootFloor(const TBigInt &num, uint32_t k) {
+    size_t bits = num.bitLength(), rootBits = (bits + k - 1) / k, margin = 2 + static_cast<size_t>(std::log2(k));
+    TBigInt root;
+    if (k >= bits) {                                    // num < 2^k
+        return TBigInt(bits ? 1 : 0);
+    } else if (rootBits <= margin + 32) {                // short roots: plain newton from a close estimate
+        root = rootEstimate(num, bits, k);
+        root = (root * (k - 1) + num / power(root, k - 1)) / k;    // at or above the root from any start
+        while (true) {
+            TBigInt next = (root * (k - 1) + num / power(root, k - 1)) / k;
+            if (next >= root) {
+                break;
+            }
+            root = std::move(next);
+        }
+        return root;
+    }
+    size_t shift = (rootBits - margin) / 2;
+    root = rootFloor(num >> k * shift, k) << shift;
+    root = (root * (k - 1) + num / power(root, k - 1)) / k;
+    while (power(root, k) > num) {
+        --root;
+    }
+    return root;
+}
+
+TBigInt isqrt(const TBigInt &num) {
+    if (num < 0) {
+        throw std::domain_error("TBigInt: square root of a negative number");
+    }
+    return rootFloor(num, 2);
+}
+
+TBigInt iroot(const TBigInt &num, uint32_t k) {
+    if (!k || (num < 0 && !(k & 1))) {
+        throw std::domain_error("TBigInt: no real root");
+    } else if (k == 1 || num == 0) {
+        return num;
+    }
+    return num < 0 ? -rootFloor(-num, k) : rootFloor(num, k);
+}
+
+bool isPerfectSquare(const TBigInt &num) {
+    if (num < 0) {
+        return false;
+    } else if (num == 0) {
+        return true;
+    }
+    uint32_t low = TBigIntView(num).limbs()[0];
+    if ((0x202021202030213ull >> (low & 63) & 1) == 0) {    // squares mod 64
+        return false;
+    }
+    TBigInt root = isqrt(num);
+    return root.square() == num;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "bigint.h"
+
+// Newton iteration on a root of the number's upper half, so every level doubles the
+// precision and the last one, a single division at full size, dominates the cost.
+TBigInt isqrt(const TBigInt&);                          // floor; throws domain_error below zero
+TBigInt iroot(const TBigInt&, uint32_t);                // rounds towards zero; even roots of negatives throw
+bool isPerfectSquare(const TBigInt&);
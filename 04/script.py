@@ -1,21 +1,120 @@
 #!/usr/bin/python3
+import math
+import sys
 
 
-def apply(operation, first, second):
+def iroot(num, k):
+    if not k or (num < 0 and not k % 2):
+        raise ValueError('no real root')
+    if num <= 0:
+        return -iroot(-num, k) if num else 0
+    root = 1 << -(-num.bit_length() // k)
+    while True:
+        following = ((k - 1) * root + num // root ** (k - 1)) // k
+        if following >= root:
+            return root
+        root = following
+
+
+# g, s, t with s a + t b = g and, unless b is zero, s reduced into [0, |b| / g).
+def gcdext(first, second):
+    rem, following, coef, coefFollowing = abs(first), abs(second), 1, 0
+    while following:
+        quot = rem // following
+        rem, following = following, rem - quot * following
+        coef, coefFollowing = coefFollowing, coef - quot * coefFollowing
+    coef = -coef if first < 0 else coef
+    if not second:
+        return rem, coef, 0
+    coef %= abs(second) // rem
+    return rem, coef, (rem - coef * first) // second
+
+
+def apply(operation, first, *rest):
+    second = rest[0] if rest else None
     if operation == '-':
         return first - second
     elif operation == '+':
         return first + second
     elif operation == '*':
         return first * second
+    elif operation == '/':
+        quot = abs(first) // abs(second)
+        return quot if (first < 0) == (second < 0) else -quot
+    elif operation == '%':
+        return first - second * apply('/', first, second)
+    elif operation == '<<':
+        return first << second
+    elif operation == '>>':
+        return first >> second
+    elif operation == 'cmp':
+        return (first > second) - (first < second)
+    elif operation == 'gcd':
+        return math.gcd(first, second)
+    elif operation == 'lcm':
+        return math.lcm(first, second)
+    elif operation == 'gcdext':
+        return gcdext(first, second)
+    elif operation == 'invmod':
+        if second <= 0 or math.gcd(first, second) != 1:
+            raise ValueError('not invertible')
+        return pow(first, -1, second)
+    elif operation == 'powmod':
+        if rest[1] <= 0 or second < 0:
+            raise ValueError('bad exponent or modulus')
+        return pow(first, second, rest[1])
+    elif operation == 'isqrt':
+        return math.isqrt(first)
+    elif operation == 'iroot':
+        return iroot(first, second)
+    elif operation == 'addmul':
+        return first + second * rest[1]
+    elif operation == 'submul':
+        return first - second * rest[1]
     return None
 
 
+# Operands in hex ("-0x1f") make the answer hex as well: python's decimal conversions are
+# quadratic, the large operands go both ways in hex.
+def show(value, hexadecimal):
+    if isinstance(value, tuple):
+        return ' '.join(show(part, hexadecimal) for part in value)
+    return hex(value) if hexadecimal else str(value)
+
+
+# "first operation rest...", like "5 + 7", "2 powmod 10 1000" or "16 isqrt".
+def evaluate(line):
+    splitted = line.split()
+    operands = [splitted[0]] + splitted[2:]
+    hexadecimal = any('x' in operand for operand in operands)
+    try:
+        value = apply(splitted[1], *(int(operand, 16) if 'x' in operand else int(operand) for operand in operands))
+    except (ZeroDivisionError, ValueError):
+        return 'error'
+    return show(value, hexadecimal)
+
+
+# Expressions one per line, each batch ended by an empty line. The answers of a batch are
+# written in order once it is complete, so the caller can send a whole batch before
+# reading anything back.
+def batch():
+    pending = []
+    for line in sys.stdin:
+        if line.strip():
+            pending.append(line)
+            continue
+        sys.stdout.write(''.join(f'{evaluate(expression)}\n' for expression in pending))
+        sys.stdout.flush()
+        pending = []
+
+
 def main():
-    splitted = input().split()
-    first, second = map(int, splitted[::2])
-    operation = splitted[1]
-    print(apply(operation, first, second))
+    if hasattr(sys, 'set_int_max_str_digits'):
+        sys.set_int_max_str_digits(0)
+    if sys.argv[1:] == ['--batch']:
+        batch()
+    else:
+        print(evaluate(input()))
 
 
 if __name__ == "__main__":
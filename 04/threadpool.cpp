@@ -0,0 +1,128 @@
+#include "threadpool.h"
+
+#include <utility>
+
+static thread_local const TThreadPool *currentPool = nullptr;
+static thread_local size_t currentQueue = 0;
+
+TThreadPool::TTask::TTask(std::function<void()> func) : run(std::move(func)), error(), done(false), pool(nullptr) {}
+
+TThreadPool::TTask::~TTask() {
+    if (pool) {
+        pool->finish(*this);                            // the queue must not keep a pointer to this
+    }
+}
+
+TThreadPool::TThreadPool(size_t threads)
+    : queues()
+    , workers()
+    , sleepLock()
+    , wakeUp()
+    , pending(0)
+    , stop(false)
+{
+    for (size_t i = 0; i <= threads; ++i) {
+        queues.push_back(std::make_unique<TQueue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&TThreadPool::work, this, i);
+    }
+}
+
+TThreadPool::~TThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stop = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+size_t TThreadPool::size() const {
+    return workers.size();
+}
+
+size_t TThreadPool::self() const {
+    return currentPool == this ? currentQueue : workers.size();
+}
+
+bool TThreadPool::runOne(size_t idx) {
+    for (size_t i = 0; i < queues.size(); ++i) {
+        TQueue &queue = *queues[(idx + i) % queues.size()];
+        TTask *task = nullptr;
+        {
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.tasks.empty()) {
+                continue;
+            } else if (i) {                             // steal the oldest, most likely the biggest
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+            } else {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            }
+        }
+        --pending;
+        try {
+            task->run();
+        } catch (...) {
+            task->error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            task->done.store(true, std::memory_order_release);
+        }
+        wakeUp.notify_all();                            // the task may be gone from here on
+        return true;
+    }
+    return false;
+}
+
+void TThreadPool::work(size_t idx) {
+    currentPool = this;
+    currentQueue = idx;
+    while (true) {
+        if (runOne(idx)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wakeUp.wait(guard, [this] { return stop || pending; });
+        if (stop && !pending) {
+            return;
+        }
+    }
+}
+
+void TThreadPool::submit(TTask &task) {
+    TQueue &queue = *queues[self()];
+    task.pool = this;
+    ++pending;                                          // never below the number of queued tasks
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(&task);
+    }
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wakeUp.notify_all();                                // idle workers and threads waiting for other tasks
+}
+
+void TThreadPool::finish(TTask &task) {
+    size_t idx = self();
+    while (!task.done.load(std::memory_order_acquire)) {
+        if (runOne(idx)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wakeUp.wait(guard, [&task, this] { return task.done.load(std::memory_order_acquire) || pending; });
+    }
+}
+
+void TThreadPool::wait(TTask &task) {
+    finish(task);
+    if (task.error) {
+        std::rethrow_exception(std::exchange(task.error, nullptr));
+    }
+}
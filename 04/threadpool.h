@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fork-join pool: each worker pops the newest task of its own deque and steals the
+// oldest ones of the others. A thread waiting for a task keeps running other tasks and
+// sleeps only when there are none.
+class TThreadPool {
+public:
+    class TTask {
+    private:
+        std::function<void()> run;
+        std::exception_ptr error;                       // thrown by run, rethrown by wait()
+        std::atomic<bool> done;
+        TThreadPool *pool;                              // set once submitted
+
+        friend class TThreadPool;
+    public:
+        explicit TTask(std::function<void()>);
+        TTask(const TTask&) = delete;
+        TTask& operator=(const TTask&) = delete;
+        ~TTask();                                       // a submitted task is waited for, also while unwinding
+    };
+private:
+    struct TQueue {
+        std::mutex lock;
+        std::deque<TTask*> tasks;
+
+        TQueue() : lock(), tasks() {}
+    };
+
+    std::vector<std::unique_ptr<TQueue>> queues;        // one per worker, the last one for outside threads
+    std::vector<std::thread> workers;
+    std::mutex sleepLock;
+    std::condition_variable wakeUp;                     // new tasks and finished ones
+    std::atomic<size_t> pending;
+    bool stop;                                          // guarded by sleepLock
+
+    size_t self() const;
+    bool runOne(size_t);
+    void work(size_t);
+    void finish(TTask&);
+public:
+    explicit TThreadPool(size_t);
+    TThreadPool(const TThreadPool&) = delete;
+    TThreadPool& operator=(const TThreadPool&) = delete;
+    ~TThreadPool();
+
+    size_t size() const;
+
+    void submit(TTask&);
+    void wait(TTask&);                                  // rethrows what the task threw
+};
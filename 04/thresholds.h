@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Limbs of the shorter operand where each multiplication tier takes over from the ones
+// below. Generated by make tune on the build machine, BIGINT_THRESHOLDS overrides them
+// at startup (see TBigInt::setThresholds).
+constexpr size_t tunedKaratsubaThreshold = 51;
+constexpr size_t tunedToom3Threshold = 826;
+constexpr size_t tunedToom4Threshold = 1175;
+constexpr size_t tunedNttThreshold = 50764;
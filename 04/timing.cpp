@@ -0,0 +1,37 @@
+#include "timing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+TBigInt randomNumber(size_t limbs, std::mt19937 &gen) {
+    std::vector<uint32_t> data(limbs);
+    std::generate(data.begin(), data.end(), std::ref(gen));
+    data.back() |= 1;
+    return TBigInt(TBigIntView(TVector::TVectorView(data.size(), data.data()), false));
+}
+
+double measure(const std::function<void()> &op, double minTime) {
+    using TClock = std::chrono::steady_clock;
+    size_t reps = 1;
+    double best = 0;
+    for (bool calibrated = false; !calibrated; ) {      // grow the batch until it takes long enough
+        auto start = TClock::now();
+        for (size_t i = 0; i < reps; ++i) {
+            op();
+        }
+        best = std::chrono::duration<double>(TClock::now() - start).count();
+        calibrated = best >= minTime / timingBatches || reps >= (1u << 30);
+        if (!calibrated) {
+            reps = best > 0 ? std::max(2 * reps, static_cast<size_t>(reps * minTime / timingBatches / best)) : 2 * reps;
+        }
+    }
+    for (size_t i = 1; i < timingBatches; ++i) {
+        auto start = TClock::now();
+        for (size_t j = 0; j < reps; ++j) {
+            op();
+        }
+        best = std::min(best, std::chrono::duration<double>(TClock::now() - start).count());
+    }
+    return best / reps * 1e9;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "bigint.h"
+
+#include <functional>
+#include <random>
+
+// Shared by the benchmark and the tuner.
+constexpr size_t timingBatches = 3;
+
+TBigInt randomNumber(size_t, std::mt19937&);            // exactly that many limbs
+double measure(const std::function<void()>&, double);  // ns per call, best batch within about the given seconds
@@ -0,0 +1,133 @@
+#include "bigint.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Finds where each multiplication tier starts to beat the ones below it on this machine and
+// writes the crossovers as thresholds.h. A tier is timed one level deep: at n limbs it runs
+// once on top and hands its sub-products to the tiers tuned before it, the ones above stay off.
+struct TOptions {
+    std::string output = "thresholds.h";
+    double minTime = 0.02;                              // seconds per timing, split over the batches
+};
+
+struct TTier {
+    const char *name;
+    size_t TBigInt::TThresholds::*threshold;
+    size_t to;                                          // limbs probed, from the tier below
+};
+
+constexpr size_t confirmations = 3;                     // wins in a row before the first one counts
+constexpr size_t rounds = 3;
+
+// Lower tiers capped by the ones above, as setThresholds wants them. A tier capped to the
+// threshold of the next one is switched off: that one is tried first.
+static TBigInt::TThresholds ordered(TBigInt::TThresholds obj) {
+    obj.toom4 = std::min(obj.toom4, obj.ntt);
+    obj.toom3 = std::min(obj.toom3, obj.toom4);
+    obj.karatsuba = std::min(obj.karatsuba, obj.toom3);
+    return obj;
+}
+
+// The first size of a winning streak, or SIZE_MAX if the tier never wins.
+static size_t crossover(const TTier &tier, const TBigInt::TThresholds &tuned, size_t from, double minTime) {
+    std::mt19937 gen(20240601);
+    size_t first = SIZE_MAX, wins = 0;
+    for (size_t size = from; size <= tier.to && wins < confirmations; size = std::max(size + 1, size * 9 / 8)) {
+        TBigInt lhs = randomNumber(size, gen), rhs = randomNumber(size, gen), res;
+        TBigInt::TThresholds with = tuned, without = ordered(tuned);
+        with.*tier.threshold = size;
+        with = ordered(with);
+        double below = HUGE_VAL, above = HUGE_VAL;
+        for (size_t round = 0; round < rounds; ++round) {   // interleaved, so that load drifts hit both
+            TBigInt::setThresholds(without);
+            below = std::min(below, measure([&] { res = lhs * rhs; }, minTime));
+            TBigInt::setThresholds(with);
+            above = std::min(above, measure([&] { res = lhs * rhs; }, minTime));
+        }
+        std::fprintf(stderr, "%-10s %6zu limbs %14.1f -> %14.1f ns\n", tier.name, size, below, above);
+        if (above < below) {
+            first = wins++ ? first : size;
+        } else {
+            wins = 0;
+        }
+    }
+    return wins < confirmations ? SIZE_MAX : first;
+}
+
+static TBigInt::TThresholds tune(double minTime) {
+    const TTier tiers[] = {
+        { "karatsuba", &TBigInt::TThresholds::karatsuba, 256 },
+        { "toom3", &TBigInt::TThresholds::toom3, 65536 },
+        { "toom4", &TBigInt::TThresholds::toom4, 65536 },
+        { "ntt", &TBigInt::TThresholds::ntt, 65536 }
+    };
+    TBigInt::TThresholds tuned = { SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX };
+    size_t from = 4;
+    for (const TTier &tier : tiers) {
+        tuned.*tier.threshold = crossover(tier, tuned, from, minTime);
+        if (tuned.*tier.threshold != SIZE_MAX) {
+            from = tuned.*tier.threshold;
+        }
+    }
+    TBigInt::TThresholds res = ordered(tuned);
+    for (size_t i = 0; i + 1 < std::size(tiers); ++i) {
+        if (res.*tiers[i].threshold == res.*tiers[i + 1].threshold && res.*tiers[i].threshold != SIZE_MAX) {
+            std::fprintf(stderr, "%s is switched off, %s takes over at the same size\n", tiers[i].name, tiers[i + 1].name);
+        }
+    }
+    TBigInt::setThresholds(res);                        // the same checks as for BIGINT_THRESHOLDS
+    return res;
+}
+
+static void write(const std::string &path, const TBigInt::TThresholds &tuned) {
+    auto value = [](size_t limbs) {
+        return limbs == SIZE_MAX ? std::string("SIZE_MAX") : std::to_string(limbs);
+    };
+    std::ofstream out(path);
+    out << "#pragma once\n\n#include <cstddef>\n#include <cstdint>\n\n"
+        << "// Limbs of the shorter operand where each multiplication tier takes over from the ones\n"
+        << "// below. Generated by make tune on the build machine, BIGINT_THRESHOLDS overrides them\n"
+        << "// at startup (see TBigInt::setThresholds).\n"
+        << "constexpr size_t tunedKaratsubaThreshold = " << value(tuned.karatsuba) << ";\n"
+        << "constexpr size_t tunedToom3Threshold = " << value(tuned.toom3) << ";\n"
+        << "constexpr size_t tunedToom4Threshold = " << value(tuned.toom4) << ";\n"
+        << "constexpr size_t tunedNttThreshold = " << value(tuned.ntt) << ";\n";
+    if (!out) {
+        throw std::runtime_error("tuner: cannot write " + path);
+    }
+}
+
+int main(int argc, char **argv) {
+    TOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--output" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTime = std::stod(argv[++i]);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--output FILE] [--min-time SECONDS]" << std::endl;
+            return 2;
+        }
+    }
+    try {
+        TBigInt::TThresholds tuned = tune(options.minTime);
+        if (tuned.karatsuba == SIZE_MAX) {
+            throw std::runtime_error("tuner: karatsuba never beat schoolbook, keeping " + options.output);
+        }
+        write(options.output, tuned);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
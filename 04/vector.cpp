@@ -1,21 +1,34 @@
 #include "vector.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <new>
+
+// malloc rather than new[], so that growing a heap buffer can realloc it in place.
+static uint32_t* allocateLimbs(size_t cap) {
+    void *ptr = std::malloc(cap * sizeof(uint32_t));
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return static_cast<uint32_t*>(ptr);
+}
 
-TVector::TVector() : Capacity(), Size(), Ptr(nullptr) {}
+TVector::TVector() : Capacity(inlineCapacity), Size(), Ptr(Inline), Inline() {}
 
 TVector::TVector(std::initializer_list<uint32_t> brace_enclosed_list)
-    : Capacity(brace_enclosed_list.size())
+    : Capacity(std::max(brace_enclosed_list.size(), inlineCapacity))
     , Size(brace_enclosed_list.size())
-    , Ptr(new uint32_t[Capacity])
+    , Ptr(Capacity > inlineCapacity ? allocateLimbs(Capacity) : Inline)
+    , Inline()
 {
     std::copy(brace_enclosed_list.begin(), brace_enclosed_list.end(), begin());
 }
 
 TVector::TVector(TVectorView view)
-    : Capacity(view.size())
+    : Capacity(std::max(view.size(), inlineCapacity))
     , Size(view.size())
-    , Ptr(new uint32_t[Capacity])
+    , Ptr(Capacity > inlineCapacity ? allocateLimbs(Capacity) : Inline)
+    , Inline()
 {
     std::copy(view.begin(), view.end(), begin());
 }
@@ -23,7 +36,8 @@ TVector::TVector(TVectorView view)
 TVector::TVector(const TVector &obj)
     : Capacity(obj.Capacity)
     , Size(obj.Size)
-    , Ptr(new uint32_t[Capacity])
+    , Ptr(obj.isInline() ? Inline : allocateLimbs(Capacity))
+    , Inline()
 {
     std::copy(obj.begin(), obj.end(), begin());
 }
@@ -31,14 +45,36 @@ TVector::TVector(const TVector &obj)
 TVector::TVector(TVector &&obj)
     : Capacity(obj.Capacity)
     , Size(obj.Size)
-    , Ptr(obj.Ptr)
+    , Ptr(obj.isInline() ? Inline : obj.Ptr)
+    , Inline()
 {
-    obj.Ptr = nullptr;
-    obj.Capacity = obj.Size = 0;
+    if (obj.isInline()) {
+        std::copy(obj.begin(), obj.end(), Inline);
+    }
+    obj.Ptr = obj.Inline;
+    obj.Capacity = inlineCapacity;
+    obj.Size = 0;
 }
 
 TVector::~TVector() {
-    delete[] Ptr;
+    release();
+}
+
+bool TVector::isInline() const {
+    return Ptr == Inline;
+}
+
+void TVector::release() {
+    if (!isInline()) {
+        std::free(Ptr);
+    }
+}
+
+void TVector::allocate(size_t cap) {
+    uint32_t *tmp = allocateLimbs(cap);
+    release();
+    Ptr = tmp;
+    Capacity = cap;
 }
 
 bool TVector::empty() const {
@@ -55,11 +91,7 @@ size_t TVector::size() const {
 
 void TVector::push_back(uint32_t val) {
     if (Size == Capacity) {
-        Capacity = Capacity ? Capacity << 1 : 1;
-        uint32_t *tmp = new uint32_t[Capacity];         // not safe
-        std::copy(begin(), end(), tmp);
-        delete[] Ptr;
-        Ptr = tmp;
+        reserve(Capacity << 1);
     }
     Ptr[Size++] = val;
 }
@@ -73,13 +105,20 @@ void TVector::clear() {
 }
 
 void TVector::reserve(size_t cap) {
-    if (cap > Capacity) {
-        uint32_t *tmp = new uint32_t[cap];              // not safe
+    if (cap <= Capacity) {
+        return;
+    } else if (isInline()) {
+        uint32_t *tmp = allocateLimbs(cap);
         std::copy(begin(), end(), tmp);
-        delete[] Ptr;
         Ptr = tmp;
-        Capacity = cap;
+    } else {
+        void *tmp = std::realloc(Ptr, cap * sizeof(uint32_t));
+        if (!tmp) {
+            throw std::bad_alloc();
+        }
+        Ptr = static_cast<uint32_t*>(tmp);
     }
+    Capacity = cap;
 }
 
 void TVector::resize(size_t s) {
@@ -90,11 +129,14 @@ void TVector::resize(size_t s) {
     Size = s;
 }
 
+void TVector::resize_uninitialized(size_t s) {
+    reserve(s);
+    Size = s;
+}
+
 TVector& TVector::operator=(std::initializer_list<uint32_t> brace_enclosed_list) {
     if (capacity() < brace_enclosed_list.size()) {
-        delete[] Ptr;
-        Capacity = brace_enclosed_list.size();
-        Ptr = new uint32_t[Capacity];                   // not safe
+        allocate(brace_enclosed_list.size());
     }
     Size = brace_enclosed_list.size();
     std::copy(brace_enclosed_list.begin(), brace_enclosed_list.end(), begin());
@@ -103,9 +145,7 @@ TVector& TVector::operator=(std::initializer_list<uint32_t> brace_enclosed_list)
 
 TVector& TVector::operator=(TVectorView view) {
     if (capacity() < view.size()) {
-        delete[] Ptr;
-        Capacity = view.size();
-        Ptr = new uint32_t[Capacity];                   // not safe
+        allocate(view.size());
     }
     Size = view.size();
     std::copy(view.begin(), view.end(), begin());
@@ -113,10 +153,10 @@ TVector& TVector::operator=(TVectorView view) {
 }
 
 TVector& TVector::operator=(const TVector &obj) {
-    if (capacity() < obj.capacity()) {
-        delete[] Ptr;
-        Capacity = obj.Capacity;
-        Ptr = new uint32_t[Capacity];                   // not safe
+    if (this == &obj) {
+        return *this;
+    } else if (capacity() < obj.size()) {
+        allocate(obj.Capacity);
     }
     Size = obj.size();
     std::copy(obj.begin(), obj.end(), begin());
@@ -124,12 +164,20 @@ TVector& TVector::operator=(const TVector &obj) {
 }
 
 TVector& TVector::operator=(TVector &&obj) {
-    delete[] Ptr;
-    Capacity = obj.capacity();
-    Size = obj.size();
-    Ptr = obj.begin();
-    obj.Ptr = nullptr;
-    obj.Capacity = obj.Size = 0;
+    if (this == &obj) {                                 // release() below would free the limbs being taken
+        return *this;
+    } else if (obj.isInline()) {                        // nothing to steal, the limbs fit anywhere
+        Size = obj.size();
+        std::copy(obj.begin(), obj.end(), begin());
+    } else {
+        release();
+        Capacity = obj.capacity();
+        Size = obj.size();
+        Ptr = obj.begin();
+        obj.Ptr = obj.Inline;
+        obj.Capacity = inlineCapacity;
+    }
+    obj.Size = 0;
     return *this;
 }
 
@@ -3,10 +3,17 @@
 #include <iterator>
 
 class TVector {
+public:
+    constexpr static size_t inlineCapacity = 4;         // limbs kept in the object itself
 private:
     size_t Capacity;
     size_t Size;
-    uint32_t *Ptr;
+    uint32_t *Ptr;                                      // points at Inline until the data outgrows it
+    uint32_t Inline[inlineCapacity];
+
+    bool isInline() const;
+    void release();
+    void allocate(size_t);                              // a fresh buffer, the limbs are not kept
 public:
     class TVectorView {
     private:
@@ -50,6 +57,7 @@ public:
     void clear();
     void reserve(size_t);
     void resize(size_t);
+    void resize_uninitialized(size_t);                  // for callers that write every new limb
 
     TVector& operator=(std::initializer_list<uint32_t>);
     TVector& operator=(TVectorView);